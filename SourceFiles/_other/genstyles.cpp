@@ -1056,6 +1056,23 @@ struct Font {
 typedef QMap<string, Font> Fonts;
 QMap<int, Fonts> fonts;
 
+template <typename Values>
+typename Values::const_iterator findVariantValue(const QMap<int, Values> &byVariant, int variantIndex, const string &name) { // falls back to the first scale that has the value
+	typename QMap<int, Values>::const_iterator values = byVariant.constFind(variants[variantIndex]);
+	if (values != byVariant.cend()) {
+		typename Values::const_iterator i = values.value().constFind(name);
+		if (i != values.value().cend()) return i;
+	}
+	for (int v = 0; v < variantsCount; ++v) {
+		values = byVariant.constFind(variants[v]);
+		if (values == byVariant.cend()) continue;
+
+		typename Values::const_iterator i = values.value().constFind(name);
+		if (i != values.value().cend()) return i;
+	}
+	throw Exception(QString("Value '%1' not found in any scale!").arg(name.c_str()));
+}
+
 ScalarValue prepareFont(int variant, const string &name, const char *&text, const char *end) {
 	StyleGenTokenType type;
 	string token;
@@ -1603,7 +1620,127 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org\n\
 			tcpp << "\tFontDatas _fontsMap;\n";
 			tcpp << "\tColorDatas _colorsMap;\n";
 			tcpp << "\tint _spriteWidth = " << spriteWidths[0] << ";\n\n";
+
+			// colors and fonts are written as flat tables: a palette of distinct values
+			// and, for each scale, the palette index of every style color and font
+			typedef QMap<string, int> FontFamilies;
+			QVector<FontFamilies> variantFamilies(variantsCount);
+			QVector<QVector<string> > variantFamiliesList(variantsCount);
+
+			typedef QMap<string, int> TableIndices;
+			TableIndices colorNames, colorValues, fontNames, fontValues;
+			QVector<string> colorPalette, fontPalette;
+			for (int i = 0; i < variantsCount; ++i) {
+				const Colors &clrs(colors[variants[i]]);
+				for (Colors::const_iterator j = clrs.cbegin(), e = clrs.cend(); j != e; ++j) {
+					colorNames.insert(j.key(), 0);
+				}
+				const Fonts &fnts(fonts[variants[i]]);
+				for (Fonts::const_iterator j = fnts.cbegin(), e = fnts.cend(); j != e; ++j) {
+					fontNames.insert(j.key(), 0);
+				}
+			}
+			int tableIndex = 0;
+			for (TableIndices::iterator i = colorNames.begin(), e = colorNames.end(); i != e; ++i) {
+				i.value() = tableIndex++;
+			}
+			tableIndex = 0;
+			for (TableIndices::iterator i = fontNames.begin(), e = fontNames.end(); i != e; ++i) {
+				i.value() = tableIndex++;
+			}
+
+			QVector<QVector<int> > colorIndices(variantsCount), fontIndices(variantsCount);
+			for (int i = 0; i < variantsCount; ++i) {
+				ByName::const_iterator j = scalarsMap.constFind("defaultFontFamily");
+				if (j == scalarsMap.cend()) {
+					throw Exception(QString("defaultFontFamily not found!"));
+				} else if (scalars[j.value()].second.first != scString) {
+					throw Exception(QString("defaultFontFamily has bad type!"));
+				} else if (scalars[j.value()].second.second.empty()) {
+					throw Exception(QString("Unexpected empty string in defaultFontFamily!"));
+				}
+				string defaultFamily = findScalarVariant(scalars[j.value()].second.second, variants[i]);
+				variantFamilies[i].insert(defaultFamily, 0);
+				variantFamiliesList[i].push_back(defaultFamily);
+
+				for (TableIndices::const_iterator j = colorNames.cbegin(), e = colorNames.cend(); j != e; ++j) {
+					const string &value(findVariantValue(colors, i, j.key()).value().color);
+					TableIndices::const_iterator k = colorValues.constFind(value);
+					if (k == colorValues.cend()) {
+						k = colorValues.insert(value, colorPalette.size());
+						colorPalette.push_back(value);
+					}
+					colorIndices[i].push_back(k.value());
+				}
+
+				for (TableIndices::const_iterator j = fontNames.cbegin(), e = fontNames.cend(); j != e; ++j) {
+					const Font &font(findVariantValue(fonts, i, j.key()).value());
+					FontFamilies::const_iterator family = variantFamilies[i].constFind(font.family);
+					if (family == variantFamilies[i].cend()) {
+						family = variantFamilies[i].insert(font.family, variantFamiliesList[i].size());
+						variantFamiliesList[i].push_back(font.family);
+					}
+					string value = font.size + ", " + QString::number(font.flags).toUtf8().constData() + ", " + QString::number(family.value()).toUtf8().constData();
+					TableIndices::const_iterator k = fontValues.constFind(value);
+					if (k == fontValues.cend()) {
+						k = fontValues.insert(value, fontPalette.size());
+						fontPalette.push_back(value);
+					}
+					fontIndices[i].push_back(k.value());
+				}
+			}
+			if (colorPalette.size() > 0xFFFF || fontPalette.size() > 0xFFFF) {
+				throw Exception(QString("Too many different colors or fonts!"));
+			}
+
+			tcpp << "\tnamespace {\n";
+			if (!colorNames.isEmpty()) {
+				tcpp << "\t\tstyle::color * const _colorsList[] = {\n";
+				for (TableIndices::const_iterator i = colorNames.cbegin(), e = colorNames.cend(); i != e; ++i) {
+					tcpp << "\t\t\t&_" << i.key().c_str() << ",\n";
+				}
+				tcpp << "\t\t};\n";
+				tcpp << "\t\tconst uchar _colorsPalette[][4] = { // r, g, b, a\n";
+				for (int i = 0, l = colorPalette.size(); i < l; ++i) {
+					tcpp << "\t\t\t{ " << colorPalette.at(i).c_str() << " },\n";
+				}
+				tcpp << "\t\t};\n";
+				tcpp << "\t\tconst uint16 _colorsIndices[][" << colorNames.size() << "] = {\n";
+				for (int i = 0; i < variantsCount; ++i) {
+					tcpp << "\t\t\t{ // " << variantNames[i];
+					for (int j = 0, l = colorIndices[i].size(); j < l; ++j) {
+						tcpp << ((j % 16) ? " " : "\n\t\t\t\t") << colorIndices[i].at(j) << ",";
+					}
+					tcpp << "\n\t\t\t},\n";
+				}
+				tcpp << "\t\t};\n";
+			}
+			if (!fontNames.isEmpty()) {
+				tcpp << "\t\tstyle::font * const _fontsList[] = {\n";
+				for (TableIndices::const_iterator i = fontNames.cbegin(), e = fontNames.cend(); i != e; ++i) {
+					tcpp << "\t\t\t&_" << i.key().c_str() << ",\n";
+				}
+				tcpp << "\t\t};\n";
+				tcpp << "\t\tconst uint32 _fontsPalette[][3] = { // size, flags, index in _fontFamilies\n";
+				for (int i = 0, l = fontPalette.size(); i < l; ++i) {
+					tcpp << "\t\t\t{ " << fontPalette.at(i).c_str() << " },\n";
+				}
+				tcpp << "\t\t};\n";
+				tcpp << "\t\tconst uint16 _fontsIndices[][" << fontNames.size() << "] = {\n";
+				for (int i = 0; i < variantsCount; ++i) {
+					tcpp << "\t\t\t{ // " << variantNames[i];
+					for (int j = 0, l = fontIndices[i].size(); j < l; ++j) {
+						tcpp << ((j % 16) ? " " : "\n\t\t\t\t") << fontIndices[i].at(j) << ",";
+					}
+					tcpp << "\n\t\t\t},\n";
+				}
+				tcpp << "\t\t};\n";
+			}
+			tcpp << "\t}\n\n";
+
 			tcpp << "\tvoid startManager() {\n";
+			tcpp << "\t\t_fontsMap.reserve(" << fontPalette.size() << ");\n";
+			tcpp << "\t\t_colorsMap.reserve(" << colorPalette.size() << ");\n";
             
             tcpp << "\n\t\tif (cRetina()) {\n";
 			tcpp << "\t\t\tcSetRealScale(dbisOne);\n";
@@ -1654,22 +1791,6 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org\n\
 			}
 			tcpp << "\t\t}\n\n";
 
-			Colors &clrs(colors[variant]);
-			for (Colors::const_iterator i = clrs.cbegin(), e = clrs.cend(); i != e; ++i) {
-				bool differ = false;
-				for (int j = 1; j < variantsCount; ++j) {
-					const Colors &otherClrs(colors[variants[j]]);
-					Colors::const_iterator k = otherClrs.constFind(i.key());
-					if (k == otherClrs.cend() || k.value().color != i.value().color) {
-						differ = true;
-						break;
-					}
-				}
-				if (!differ) {
-					tcpp << "\t\t_" << i.key().c_str() << ".init(" << i.value().color.c_str() << ");\n";
-				}
-			}
-
 			for (int i = 0; i < variantsCount; ++i) {
 				variant = variants[i];
 				Named &nmd(named[variant]);
@@ -1689,60 +1810,51 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org\n\
 				}
 			}
 
-			tcpp << "\n\t\tswitch (cScale()) {\n\n";
+			tcpp << "\n\t\tint32 scaleIndex = 0;\n";
+			tcpp << "\t\tswitch (cScale()) {\n\n";
 			for (int i = 0; i < variantsCount; ++i) {
-				variant = variants[i];
-				const char *varName = variantNames[i];
-
-				tcpp << "\t\tcase " << varName << ":\n";
-
-				typedef QMap<string, int> FontFamilies;
-				FontFamilies fontFamilies;
-				int familyIndex = 0;
-				ByName::const_iterator j = scalarsMap.constFind("defaultFontFamily");
-				if (j != scalarsMap.cend()) {
-					if (scalars[j.value()].second.first == scString) {
-						if (scalars[j.value()].second.second.empty()) {
-							throw Exception(QString("Unexpected empty string in defaultFontFamily!").arg(token.c_str()));
-						}
-						string v = findScalarVariant(scalars[j.value()].second.second, variant);
-						tcpp << "\t\t\t_fontFamilies.push_back" << v.c_str() << ";\n";
-						fontFamilies.insert(v, familyIndex++);
-					} else {
-						throw Exception(QString("defaultFontFamily has bad type!"));
-					}
-				} else {
-					throw Exception(QString("defaultFontFamily not found!"));
+				tcpp << "\t\tcase " << variantNames[i] << ":\n";
+				tcpp << "\t\t\tscaleIndex = " << i << ";\n";
+				for (int j = 0, l = variantFamiliesList[i].size(); j < l; ++j) {
+					tcpp << "\t\t\t_fontFamilies.push_back" << variantFamiliesList[i].at(j).c_str() << ";\n";
 				}
+				tcpp << "\t\tbreak;\n\n";
+			}
+			tcpp << "\t\t}\n\n";
 
-				Fonts &fnts(fonts[variant]);
-				for (Fonts::const_iterator i = fnts.cbegin(), e = fnts.cend(); i != e; ++i) {
-					FontFamilies::const_iterator j = fontFamilies.constFind(i.value().family);
-					if (j == fontFamilies.cend()) {
-						tcpp << "\n\t\t\t_fontFamilies.push_back" << i.value().family.c_str() << ";\n";
-						j = fontFamilies.insert(i.value().family, familyIndex++);
-					}
-					tcpp << "\t\t\t_" << i.key().c_str() << ".init(" << i.value().size.c_str() << ", " << i.value().flags << ", " << j.value() << ", 0);\n";
-				}
+			if (!colorNames.isEmpty()) { // palette entries are initialized once, all other colors with the same value share their data
+				tcpp << "\t\tstyle::color *colorsInited[" << colorPalette.size() << "] = { 0 };\n";
+				tcpp << "\t\tfor (int32 i = 0; i < " << colorNames.size() << "; ++i) {\n";
+				tcpp << "\t\t\tuint16 index = _colorsIndices[scaleIndex][i];\n";
+				tcpp << "\t\t\tif (colorsInited[index]) {\n";
+				tcpp << "\t\t\t\t*_colorsList[i] = *colorsInited[index];\n";
+				tcpp << "\t\t\t} else {\n";
+				tcpp << "\t\t\t\tconst uchar *value = _colorsPalette[index];\n";
+				tcpp << "\t\t\t\t_colorsList[i]->init(value[0], value[1], value[2], value[3]);\n";
+				tcpp << "\t\t\t\tcolorsInited[index] = _colorsList[i];\n";
+				tcpp << "\t\t\t}\n";
+				tcpp << "\t\t}\n\n";
+			}
+			if (!fontNames.isEmpty()) {
+				tcpp << "\t\tstyle::font *fontsInited[" << fontPalette.size() << "] = { 0 };\n";
+				tcpp << "\t\tfor (int32 i = 0; i < " << fontNames.size() << "; ++i) {\n";
+				tcpp << "\t\t\tuint16 index = _fontsIndices[scaleIndex][i];\n";
+				tcpp << "\t\t\tif (fontsInited[index]) {\n";
+				tcpp << "\t\t\t\t*_fontsList[i] = *fontsInited[index];\n";
+				tcpp << "\t\t\t} else {\n";
+				tcpp << "\t\t\t\tconst uint32 *value = _fontsPalette[index];\n";
+				tcpp << "\t\t\t\t_fontsList[i]->init(value[0], value[1], value[2], 0);\n";
+				tcpp << "\t\t\t\tfontsInited[index] = _fontsList[i];\n";
+				tcpp << "\t\t\t}\n";
+				tcpp << "\t\t}\n\n";
+			}
 
-				Colors &clrs(colors[variant]);
-				if (!clrs.empty()) tcpp << "\n";
-				for (Colors::const_iterator i = clrs.cbegin(), e = clrs.cend(); i != e; ++i) {
-					bool differ = false;
-					for (int j = 0; j < variantsCount; ++j) {
-						if (variant == variants[j]) continue;
+			tcpp << "\t\tswitch (cScale()) {\n\n";
+			for (int i = 0; i < variantsCount; ++i) {
+				variant = variants[i];
+				const char *varName = variantNames[i];
 
-						const Colors &otherClrs(colors[variants[j]]);
-						Colors::const_iterator k = otherClrs.constFind(i.key());
-						if (k == otherClrs.cend() || k.value().color != i.value().color) {
-							differ = true;
-							break;
-						}
-					}
-					if (differ) {
-						tcpp << "\t\t\t_" << i.key().c_str() << ".init(" << i.value().color.c_str() << ");\n";
-					}
-				}
+				tcpp << "\t\tcase " << varName << ":\n";
 
 				Named &nmd(named[variant]);
 				for (Named::const_iterator i = nmd.cbegin(), e = nmd.cend(); i != e; ++i) {
@@ -327,7 +327,18 @@ int main(int argc, char *argv[])
 	lzma_stream stream = LZMA_STREAM_INIT;
 
 	int preset = 9 | LZMA_PRESET_EXTREME;
+#if LZMA_VERSION >= 50020002 // multithreaded encoder is stable since xz 5.2.0
+	lzma_mt mt;
+	memset(&mt, 0, sizeof(mt));
+	mt.threads = qMax(lzma_cputhreads(), uint32_t(1));
+	mt.block_size = qMax(uint64_t(resultSize / mt.threads + 1), uint64_t(8 * 1024 * 1024)); // split to blocks for all threads, but not too small
+	mt.preset = preset;
+	mt.check = LZMA_CHECK_CRC64;
+	cout << "Compressing in " << mt.threads << " threads..\n";
+	lzma_ret ret = lzma_stream_encoder_mt(&stream, &mt);
+#else
 	lzma_ret ret = lzma_easy_encoder(&stream, preset, LZMA_CHECK_CRC64);
+#endif
 	if (ret != LZMA_OK) {
 		const char *msg;
 		switch (ret) {
@@ -346,6 +357,9 @@ int main(int argc, char *argv[])
 	stream.next_out = (uint8_t*)(compressed.data() + hSize);
 
 	lzma_ret res = lzma_code(&stream, LZMA_FINISH);
+	while (res == LZMA_OK && stream.avail_out) { // multithreaded encoder may return before finishing
+		res = lzma_code(&stream, LZMA_FINISH);
+	}
 	compressedLen -= stream.avail_out;
 	lzma_end(&stream);
 	if (res != LZMA_OK && res != LZMA_STREAM_END) {
@@ -35,6 +35,28 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 namespace {
 	App::LaunchState _launchState = App::Launched;
 
+	class MediaPreloader : public QThread {
+	public:
+		MediaPreloader(const QString &spriteFile, bool mirrored) : _spriteFile(spriteFile), _mirrored(mirrored) {
+		}
+
+		QImage sprite;
+
+	protected:
+		void run() {
+			sprite = QImage(_spriteFile);
+			if (_mirrored) sprite = sprite.mirrored(true, false);
+
+			QMimeDatabase().mimeTypeForName(qsl("text/plain")); // create mime database
+		}
+
+	private:
+		QString _spriteFile;
+		bool _mirrored;
+
+	};
+	MediaPreloader *mediaPreloader = 0;
+
 	UserData *self = 0;
 
 	typedef QHash<PeerId, PeerData*> PeersData;
@@ -74,7 +96,7 @@ namespace {
 
 	typedef QHash<MsgId, HistoryItem*> MsgsData;
 	MsgsData msgsData;
-	typedef QMap<ChannelId, MsgsData> ChannelMsgsData;
+	typedef QHash<ChannelId, MsgsData> ChannelMsgsData;
 	ChannelMsgsData channelMsgsData;
 
 	typedef QMap<uint64, FullMsgId> RandomData;
@@ -1980,9 +2002,23 @@ namespace App {
 		}
 	}
 
+	void preloadMedia() {
+		if (mediaPreloader) return;
+		mediaPreloader = new MediaPreloader(st::spriteFile, rtl());
+		mediaPreloader->start();
+	}
+
 	void initMedia() {
 		audioInit();
 
+		QImage preloadedSprite;
+		if (mediaPreloader) {
+			mediaPreloader->wait();
+			preloadedSprite = mediaPreloader->sprite;
+			delete mediaPreloader;
+			mediaPreloader = 0;
+		}
+
 		if (!::monofont) {
 			QString family;
 			tryFontFamily(family, qsl("Consolas"));
@@ -1993,7 +2029,9 @@ namespace App {
 			::monofont = style::font(st::normalFont->f.pixelSize(), 0, family);
 		}
 		if (!::sprite) {
-			if (rtl()) {
+			if (!preloadedSprite.isNull()) {
+				::sprite = new QPixmap(QPixmap::fromImage(preloadedSprite));
+			} else if (rtl()) {
 				::sprite = new QPixmap(QPixmap::fromImage(QImage(st::spriteFile).mirrored(true, false)));
 			} else {
 				::sprite = new QPixmap(st::spriteFile);
@@ -193,6 +193,7 @@ namespace App {
 
 	void clearHistories();
 
+	void preloadMedia(); // starts decoding the sprite in background, initMedia() picks it up
 	void initMedia();
 	void deinitMedia();
 	void playSound();
@@ -37,6 +37,25 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 #include "autoupdater.h"
 
 namespace {
+	class StartupTrace { // writes "name=ms;..." of each launch phase to the log
+	public:
+		StartupTrace() : _started(getms(true)), _last(_started) {
+		}
+		void done(const char *phase) {
+			uint64 ms = getms(true);
+			_phases.push_back(QString("%1=%2").arg(phase).arg(ms - _last));
+			_last = ms;
+		}
+		void finish() {
+			LOG(("Startup Info: %1;total=%2").arg(_phases.join(';')).arg(_last - _started));
+		}
+
+	private:
+		uint64 _started, _last;
+		QStringList _phases;
+
+	};
+
 	void mtpStateChanged(int32 dc, int32 state) {
 		if (App::wnd()) {
 			App::wnd()->mtpStateChanged(dc, state);
@@ -654,11 +673,15 @@ AppClass::AppClass() : QObject()
 , _translator(0) {
 	AppObject = this;
 
+	StartupTrace trace;
+
 	Fonts::start();
+	trace.done("fonts");
 
 	ThirdParty::start();
 	Global::start();
 	Local::start();
+	trace.done("local");
 	if (Local::oldSettingsVersion() < AppVersion) {
 		psNewVersion();
 	}
@@ -699,10 +722,13 @@ AppClass::AppClass() : QObject()
 	}
 
 	application()->installTranslator(_translator = new Translator());
+	trace.done("lang");
 
 	style::startManager();
+	App::preloadMedia();
 	anim::startManager();
 	historyInit();
+	trace.done("style");
 
 	DEBUG_LOG(("Application Info: inited.."));
 
@@ -716,11 +742,10 @@ AppClass::AppClass() : QObject()
 
 	DEBUG_LOG(("Application Info: starting app.."));
 
-	QMimeDatabase().mimeTypeForName(qsl("text/plain")); // create mime database
-
 	_window = new Window();
 	_window->createWinId();
 	_window->init();
+	trace.done("window");
 
 	Sandbox::connect(SIGNAL(applicationStateChanged(Qt::ApplicationState)), this, SLOT(onAppStateChanged(Qt::ApplicationState)));
 
@@ -730,8 +755,10 @@ AppClass::AppClass() : QObject()
 
 	initImageLinkManager();
 	App::initMedia();
+	trace.done("media");
 
 	Local::ReadMapState state = Local::readMap(QByteArray());
+	trace.done("map");
 	if (state == Local::ReadMapPassNeeded) {
 		cSetHasPasscode(true);
 		DEBUG_LOG(("Application Info: passcode nneded.."));
@@ -756,6 +783,8 @@ AppClass::AppClass() : QObject()
 		}
 	}
 	_window->firstShow();
+	trace.done("show");
+	trace.finish();
 
 	if (cStartToSettings()) {
 		_window->showSettings();
@@ -260,6 +260,10 @@ void audioFinish() {
 void AudioPlayer::Msg::clearData() {
 	file = FileLocation();
 	data = QByteArray();
+	if (stream) {
+		stream->abortReads();
+		stream.clear();
+	}
 	position = duration = 0;
 	frequency = AudioVoiceMsgFrequency;
 	skipStart = skipEnd = 0;
@@ -434,6 +438,7 @@ void AudioPlayer::play(const AudioMsgId &audio, int64 position) {
 				stopped = current->audio;
 			}
 			if (current->audio) {
+				if (current->stream) current->stream->abortReads();
 				emit loaderOnCancel(current->audio);
 				emit faderOnTimer();
 			}
@@ -453,7 +458,8 @@ void AudioPlayer::play(const AudioMsgId &audio, int64 position) {
 		current->audio = audio;
 		current->file = audio.audio->location(true);
 		current->data = audio.audio->data();
-		if (current->file.isEmpty() && current->data.isEmpty()) {
+		current->stream = (current->file.isEmpty() && current->data.isEmpty()) ? audio.audio->loadStream() : FileLoadStreamPtr();
+		if (current->file.isEmpty() && current->data.isEmpty() && !current->stream) {
 			setStoppedState(current, AudioPlayerStoppedAtError);
 			onError(audio);
 		} else {
@@ -468,6 +474,7 @@ void AudioPlayer::play(const AudioMsgId &audio, int64 position) {
 
 void AudioPlayer::play(const SongMsgId &song, int64 position) {
 	SongMsgId stopped;
+	bool startLoading = false;
 	{
 		QMutexLocker lock(&playerMutex);
 
@@ -478,6 +485,7 @@ void AudioPlayer::play(const SongMsgId &song, int64 position) {
 				stopped = current->song;
 			}
 			if (current->song) {
+				if (current->stream) current->stream->abortReads();
 				emit loaderOnCancel(current->song);
 				emit faderOnTimer();
 			}
@@ -497,11 +505,10 @@ void AudioPlayer::play(const SongMsgId &song, int64 position) {
 		current->song = song;
 		current->file = song.song->location(true);
 		current->data = song.song->data();
-		if (current->file.isEmpty() && current->data.isEmpty()) {
+		current->stream = (current->file.isEmpty() && current->data.isEmpty()) ? song.song->loadStream() : FileLoadStreamPtr();
+		if (current->file.isEmpty() && current->data.isEmpty() && !current->stream) {
 			setStoppedState(current);
-			if (!song.song->loading()) {
-				DocumentOpenLink::doOpen(song.song);
-			}
+			startLoading = !song.song->loading();
 		} else {
 			current->state = fadedStart ? AudioPlayerStarting : AudioPlayerPlaying;
 			current->loading = true;
@@ -509,6 +516,12 @@ void AudioPlayer::play(const SongMsgId &song, int64 position) {
 		}
 	}
 	if (stopped) emit updated(stopped);
+	if (startLoading) { // outside of the player lock
+		DocumentOpenLink::doOpen(song.song);
+		if (song.song->loadStream()) { // play this song while downloading, not the item under the cursor
+			play(song, position);
+		}
+	}
 }
 
 bool AudioPlayer::checkCurrentALError(MediaOverviewType type) {
@@ -1061,7 +1074,7 @@ void AudioPlayerFader::resumeDevice() {
 
 class AudioPlayerLoader {
 public:
-	AudioPlayerLoader(const FileLocation &file, const QByteArray &data) : file(file), access(false), data(data), dataPos(0) {
+	AudioPlayerLoader(const FileLocation &file, const QByteArray &data, const FileLoadStreamPtr &stream) : file(file), access(false), data(data), stream(stream), dataPos(0) {
 	}
 	virtual ~AudioPlayerLoader() {
 		if (access) {
@@ -1070,8 +1083,8 @@ public:
 		}
 	}
 
-	bool check(const FileLocation &file, const QByteArray &data) {
-		return this->file == file && this->data.size() == data.size();
+	bool check(const FileLocation &file, const QByteArray &data, const FileLoadStreamPtr &stream) {
+		return this->file == file && this->data.size() == data.size() && this->stream == stream;
 	}
 
 	virtual bool open(qint64 position = 0) = 0;
@@ -1085,12 +1098,13 @@ protected:
 	FileLocation file;
 	bool access;
 	QByteArray data;
+	FileLoadStreamPtr stream;
 
 	QFile f;
 	int32 dataPos;
 
 	bool openFile() {
-		if (data.isEmpty()) {
+		if (data.isEmpty() && !stream) {
 			if (f.isOpen()) f.close();
 			if (!access) {
 				if (!file.accessEnable()) {
@@ -1114,7 +1128,7 @@ protected:
 class AbstractFFMpegLoader : public AudioPlayerLoader {
 public:
 
-	AbstractFFMpegLoader(const FileLocation &file, const QByteArray &data) : AudioPlayerLoader(file, data)
+	AbstractFFMpegLoader(const FileLocation &file, const QByteArray &data, const FileLoadStreamPtr &stream = FileLoadStreamPtr()) : AudioPlayerLoader(file, data, stream)
 		, freq(AudioVoiceMsgFrequency)
 		, len(0)
 		, ioBuffer(0)
@@ -1134,7 +1148,9 @@ public:
 		char err[AV_ERROR_MAX_STRING_SIZE] = { 0 };
 
 		ioBuffer = (uchar*)av_malloc(AVBlockSize);
-		if (data.isEmpty()) {
+		if (stream) {
+			ioContext = avio_alloc_context(ioBuffer, AVBlockSize, 0, reinterpret_cast<void*>(this), &AbstractFFMpegLoader::_read_stream, 0, &AbstractFFMpegLoader::_seek_stream);
+		} else if (data.isEmpty()) {
 			ioContext = avio_alloc_context(ioBuffer, AVBlockSize, 0, reinterpret_cast<void*>(this), &AbstractFFMpegLoader::_read_file, 0, &AbstractFFMpegLoader::_seek_file);
 		} else {
 			ioContext = avio_alloc_context(ioBuffer, AVBlockSize, 0, reinterpret_cast<void*>(this), &AbstractFFMpegLoader::_read_data, 0, &AbstractFFMpegLoader::_seek_data);
@@ -1237,6 +1253,33 @@ private:
 		return l->dataPos;
 	}
 
+	static int _read_stream(void *opaque, uint8_t *buf, int buf_size) {
+		AbstractFFMpegLoader *l = reinterpret_cast<AbstractFFMpegLoader*>(opaque);
+
+		int32 nbytes = l->stream->read(l->dataPos, (char*)(buf), buf_size); // waits for the part to be downloaded
+		if (nbytes <= 0) {
+			return nbytes;
+		}
+		l->dataPos += nbytes;
+		return nbytes;
+	}
+
+	static int64_t _seek_stream(void *opaque, int64_t offset, int whence) {
+		AbstractFFMpegLoader *l = reinterpret_cast<AbstractFFMpegLoader*>(opaque);
+
+		int32 newPos = -1;
+		switch (whence) {
+		case SEEK_SET: newPos = offset; break;
+		case SEEK_CUR: newPos = l->dataPos + offset; break;
+		case SEEK_END: newPos = l->stream->size() + offset; break;
+		}
+		if (newPos < 0 || newPos > l->stream->size()) {
+			return -1;
+		}
+		l->dataPos = newPos;
+		return l->dataPos;
+	}
+
 	static int _read_file(void *opaque, uint8_t *buf, int buf_size) {
 		AbstractFFMpegLoader *l = reinterpret_cast<AbstractFFMpegLoader*>(opaque);
 		return int(l->f.read((char*)(buf), buf_size));
@@ -1260,7 +1303,7 @@ static const int32 _toChannels = 2;
 class FFMpegLoader : public AbstractFFMpegLoader {
 public:
 
-	FFMpegLoader(const FileLocation &file, const QByteArray &data) : AbstractFFMpegLoader(file, data)
+	FFMpegLoader(const FileLocation &file, const QByteArray &data, const FileLoadStreamPtr &stream = FileLoadStreamPtr()) : AbstractFFMpegLoader(file, data, stream)
 		, sampleSize(2 * sizeof(uint16))
 		, fmt(AL_FORMAT_STEREO16)
 		, srcRate(AudioVoiceMsgFrequency)
@@ -1720,7 +1763,7 @@ AudioPlayerLoader *AudioPlayerLoaders::setupLoader(MediaOverviewType type, const
 		return 0;
 	}
 
-	if (*l && (!isGoodId || !(*l)->check(m->file, m->data))) {
+	if (*l && (!isGoodId || !(*l)->check(m->file, m->data, m->stream))) {
 		delete *l;
 		*l = 0;
 		switch (type) {
@@ -1751,10 +1794,22 @@ AudioPlayerLoader *AudioPlayerLoaders::setupLoader(MediaOverviewType type, const
 //			return 0;
 //		}
 
-		*l = new FFMpegLoader(m->file, m->data);
+		*l = new FFMpegLoader(m->file, m->data, m->stream);
 
-		int ret;
-		if (!(*l)->open(position)) {
+		if (m->stream) { // opening waits for the file parts being downloaded, don't hold the player meanwhile
+			lock.unlock();
+			bool opened = (*l)->open(position);
+			lock.relock();
+
+			m = checkLoader(type);
+			if (!m) {
+				err = SetupErrorNotPlaying;
+				return 0;
+			} else if (!opened) {
+				m->state = AudioPlayerStoppedAtStart;
+				return 0;
+			}
+		} else if (!(*l)->open(position)) {
 			m->state = AudioPlayerStoppedAtStart;
 			return 0;
 		}
@@ -1800,7 +1855,7 @@ AudioPlayer::Msg *AudioPlayerLoaders::checkLoader(MediaOverviewType type) {
 	}
 	if (!l || !m) return 0;
 
-	if (!isGoodId || !m->loading || !(*l)->check(m->file, m->data)) {
+	if (!isGoodId || !m->loading || !(*l)->check(m->file, m->data, m->stream)) {
 		LOG(("Audio Error: playing changed while loading"));
 		return 0;
 	}
@@ -2548,35 +2603,9 @@ public:
 
 			const char *data = buffer.data();
 			if (fmt == AL_FORMAT_MONO8 || fmt == AL_FORMAT_STEREO8) {
-				for (int32 i = 0, l = buffer.size(); i + int32(sizeof(uchar)) <= l;) {
-					uint16 sample = qAbs((int32(*(uchar*)(data + i)) - 128) * 256);
-					if (peak < sample) {
-						peak = sample;
-					}
-
-					i += sizeof(uchar);
-					sumbytes += WaveformSamplesCount;
-					if (sumbytes >= countbytes) {
-						sumbytes -= countbytes;
-						peaks.push_back(peak);
-						peak = 0;
-					}
-				}
+				countPeaks(peaks, peak, sumbytes, countbytes, reinterpret_cast<const uchar*>(data), buffer.size() / int32(sizeof(uchar)));
 			} else if (fmt == AL_FORMAT_MONO16 || fmt == AL_FORMAT_STEREO16) {
-				for (int32 i = 0, l = buffer.size(); i + int32(sizeof(uint16)) <= l;) {
-					uint16 sample = qAbs(int32(*(int16*)(data + i)));
-					if (peak < sample) {
-						peak = sample;
-					}
-
-					i += sizeof(uint16);
-					sumbytes += sizeof(uint16) * WaveformSamplesCount;
-					if (sumbytes >= countbytes) {
-						sumbytes -= countbytes;
-						peaks.push_back(peak);
-						peak = 0;
-					}
-				}
+				countPeaks(peaks, peak, sumbytes, countbytes, reinterpret_cast<const int16*>(data), buffer.size() / int32(sizeof(int16)));
 			}
 			processed += sampleSize * samples;
 		}
@@ -2609,6 +2638,39 @@ public:
 private:
 	VoiceWaveform result;
 
+	static inline uint16 sampleAmplitude(uchar sample) {
+		return uint16(qAbs((int32(sample) - 128) * 256));
+	}
+	static inline uint16 sampleAmplitude(int16 sample) {
+		return uint16(qAbs(int32(sample)));
+	}
+
+	// splits the samples by the peaks boundaries and finds the maximum of
+	// each contiguous run in a tight loop, instead of checking the boundary per sample
+	template <typename Sample>
+	static void countPeaks(QVector<uint16> &peaks, uint16 &peak, int64 &sumbytes, int64 countbytes, const Sample *samples, int32 count) {
+		int64 step = int64(sizeof(Sample)) * WaveformSamplesCount;
+		for (int32 from = 0; from < count;) {
+			int64 tillPeak = (countbytes - sumbytes + step - 1) / step;
+			int32 till = (tillPeak < int64(count - from)) ? (from + int32(tillPeak)) : count;
+
+			uint16 runPeak = peak;
+			for (int32 i = from; i < till; ++i) {
+				uint16 sample = sampleAmplitude(samples[i]);
+				runPeak = (runPeak < sample) ? sample : runPeak;
+			}
+			peak = runPeak;
+
+			sumbytes += step * (till - from);
+			from = till;
+			if (sumbytes >= countbytes) {
+				sumbytes -= countbytes;
+				peaks.push_back(peak);
+				peak = 0;
+			}
+		}
+	}
+
 };
 
 VoiceWaveform audioCountWaveform(const FileLocation &file, const QByteArray &data) {
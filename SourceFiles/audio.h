@@ -129,6 +129,7 @@ private:
 
 		FileLocation file;
 		QByteArray data;
+		FileLoadStreamPtr stream; // played while downloading
 		int64 position, duration;
 		int32 frequency;
 		int64 skipStart, skipEnd;
@@ -227,7 +227,7 @@ void UpdateChecker::clearAll() {
 //}
 
 void UpdateChecker::unpackUpdate() {
-	QByteArray packed;
+	uint64 unpackStart = getms(true);
 	if (!outputFile.open(QIODevice::ReadOnly)) {
 		LOG(("Update Error: cant read updates file!"));
 		return fatalFail();
@@ -239,13 +239,13 @@ void UpdateChecker::unpackUpdate() {
 	const int32 hSigLen = 128, hShaLen = 20, hPropsLen = 0, hOriginalSizeLen = sizeof(int32), hSize = hSigLen + hShaLen + hOriginalSizeLen; // header
 #endif
 
-	QByteArray compressed = outputFile.readAll();
-	int32 compressedLen = compressed.size() - hSize;
-	if (compressedLen <= 0) {
-		LOG(("Update Error: bad compressed size: %1").arg(compressed.size()));
+	QByteArray header = outputFile.read(hSize);
+	int32 compressedLen = int32(outputFile.size()) - hSize;
+	if (header.size() != hSize || compressedLen <= 0) {
+		LOG(("Update Error: bad compressed size: %1").arg(outputFile.size()));
+		outputFile.close();
 		return fatalFail();
 	}
-	outputFile.close();
 
 	QString tempDirPath = cWorkingDir() + qsl("tupdates/temp"), readyFilePath = cWorkingDir() + qsl("tupdates/temp/ready");
 	psDeleteDir(tempDirPath);
@@ -253,56 +253,84 @@ void UpdateChecker::unpackUpdate() {
 	QDir tempDir(tempDirPath);
 	if (tempDir.exists() || QFile(readyFilePath).exists()) {
 		LOG(("Update Error: cant clear tupdates/temp dir!"));
+		outputFile.close();
 		return fatalFail();
 	}
 
+	// sha1 of lzma props, original size and compressed data, the file is read by UpdateChunk parts
+	SHA_CTX sha1Context;
+	SHA1_Init(&sha1Context);
+	SHA1_Update(&sha1Context, header.constData() + hSigLen + hShaLen, hPropsLen + hOriginalSizeLen);
+	for (QByteArray part = outputFile.read(UpdateChunk); !part.isEmpty(); part = outputFile.read(UpdateChunk)) {
+		SHA1_Update(&sha1Context, part.constData(), part.size());
+	}
 	uchar sha1Buffer[20];
-	bool goodSha1 = !memcmp(compressed.constData() + hSigLen, hashSha1(compressed.constData() + hSigLen + hShaLen, compressedLen + hPropsLen + hOriginalSizeLen, sha1Buffer), hShaLen);
+	SHA1_Final(sha1Buffer, &sha1Context);
+
+	bool goodSha1 = !memcmp(header.constData() + hSigLen, sha1Buffer, hShaLen);
 	if (!goodSha1) {
 		LOG(("Update Error: bad SHA1 hash of update file!"));
+		outputFile.close();
 		return fatalFail();
 	}
 
 	RSA *pbKey = PEM_read_bio_RSAPublicKey(BIO_new_mem_buf(const_cast<char*>(DevVersion ? UpdatesPublicDevKey : UpdatesPublicKey), -1), 0, 0, 0);
 	if (!pbKey) {
 		LOG(("Update Error: cant read public rsa key!"));
+		outputFile.close();
 		return fatalFail();
 	}
-	if (RSA_verify(NID_sha1, (const uchar*)(compressed.constData() + hSigLen), hShaLen, (const uchar*)(compressed.constData()), hSigLen, pbKey) != 1) { // verify signature
+	if (RSA_verify(NID_sha1, (const uchar*)(header.constData() + hSigLen), hShaLen, (const uchar*)(header.constData()), hSigLen, pbKey) != 1) { // verify signature
 		RSA_free(pbKey);
 		if (cDevVersion() || cBetaVersion()) { // try other public key, if we are in dev or beta version
 			pbKey = PEM_read_bio_RSAPublicKey(BIO_new_mem_buf(const_cast<char*>(DevVersion ? UpdatesPublicKey : UpdatesPublicDevKey), -1), 0, 0, 0);
 			if (!pbKey) {
 				LOG(("Update Error: cant read public rsa key!"));
+				outputFile.close();
 				return fatalFail();
 			}
-			if (RSA_verify(NID_sha1, (const uchar*)(compressed.constData() + hSigLen), hShaLen, (const uchar*)(compressed.constData()), hSigLen, pbKey) != 1) { // verify signature
+			if (RSA_verify(NID_sha1, (const uchar*)(header.constData() + hSigLen), hShaLen, (const uchar*)(header.constData()), hSigLen, pbKey) != 1) { // verify signature
 				RSA_free(pbKey);
 				LOG(("Update Error: bad RSA signature of update file!"));
+				outputFile.close();
 				return fatalFail();
 			}
 		} else {
 			LOG(("Update Error: bad RSA signature of update file!"));
+			outputFile.close();
 			return fatalFail();
 		}
 	}
 	RSA_free(pbKey);
 
-	QByteArray uncompressed;
-
 	int32 uncompressedLen;
-	memcpy(&uncompressedLen, compressed.constData() + hSigLen + hShaLen + hPropsLen, hOriginalSizeLen);
+	memcpy(&uncompressedLen, header.constData() + hSigLen + hShaLen + hPropsLen, hOriginalSizeLen);
+
+#ifdef Q_OS_WIN // use Lzma SDK for win, it has no streaming api in LzmaLib, so we uncompress to memory
+	outputFile.seek(hSize);
+	QByteArray compressed = outputFile.readAll(), uncompressed;
+	outputFile.close();
 	uncompressed.resize(uncompressedLen);
 
 	size_t resultLen = uncompressed.size();
-#ifdef Q_OS_WIN // use Lzma SDK for win
 	SizeT srcLen = compressedLen;
-	int uncompressRes = LzmaUncompress((uchar*)uncompressed.data(), &resultLen, (const uchar*)(compressed.constData() + hSize), &srcLen, (const uchar*)(compressed.constData() + hSigLen + hShaLen), LZMA_PROPS_SIZE);
+	int uncompressRes = LzmaUncompress((uchar*)uncompressed.data(), &resultLen, (const uchar*)compressed.constData(), &srcLen, (const uchar*)(header.constData() + hSigLen + hShaLen), LZMA_PROPS_SIZE);
 	if (uncompressRes != SZ_OK) {
 		LOG(("Update Error: could not uncompress lzma, code: %1").arg(uncompressRes));
 		return fatalFail();
 	}
-#else
+	compressed = QByteArray();
+
+	QBuffer unpacked(&uncompressed);
+	unpacked.open(QIODevice::ReadOnly);
+#else // uncompress by UpdateChunk parts to tupdates/unpacked file
+	QFile unpacked(cWorkingDir() + qsl("tupdates/unpacked"));
+	if (!unpacked.open(QIODevice::WriteOnly)) {
+		LOG(("Update Error: cant open file '%1' for writing").arg(unpacked.fileName()));
+		outputFile.close();
+		return fatalFail();
+	}
+
 	lzma_stream stream = LZMA_STREAM_INIT;
 
 	lzma_ret ret = lzma_stream_decoder(&stream, UINT64_MAX, LZMA_CONCATENATED);
@@ -315,24 +343,39 @@ void UpdateChecker::unpackUpdate() {
 		default: msg = "Unknown error, possibly a bug"; break;
 		}
 		LOG(("Error initializing the decoder: %1 (error code %2)").arg(msg).arg(ret));
+		outputFile.close();
 		return fatalFail();
 	}
 
-	stream.avail_in = compressedLen;
-	stream.next_in = (uint8_t*)(compressed.constData() + hSize);
-	stream.avail_out = resultLen;
-	stream.next_out = (uint8_t*)uncompressed.data();
+	outputFile.seek(hSize);
+	QByteArray part, result(UpdateChunk, Qt::Uninitialized);
+	int64 resultLen = 0;
+	lzma_ret res = LZMA_OK;
+	while (res == LZMA_OK) {
+		if (!stream.avail_in) {
+			part = outputFile.read(UpdateChunk);
+			stream.avail_in = part.size();
+			stream.next_in = (const uint8_t*)part.constData();
+		}
+		stream.avail_out = result.size();
+		stream.next_out = (uint8_t*)result.data();
 
-	lzma_ret res = lzma_code(&stream, LZMA_FINISH);
-	if (stream.avail_in) {
-		LOG(("Error in decompression, %1 bytes left in _in of %2 whole.").arg(stream.avail_in).arg(compressedLen));
-		return fatalFail();
-	} else if (stream.avail_out) {
-		LOG(("Error in decompression, %1 bytes free left in _out of %2 whole.").arg(stream.avail_out).arg(resultLen));
-		return fatalFail();
+		res = lzma_code(&stream, part.isEmpty() ? LZMA_FINISH : LZMA_RUN);
+
+		int32 written = result.size() - stream.avail_out;
+		if (written && unpacked.write(result.constData(), written) != written) {
+			lzma_end(&stream);
+			LOG(("Update Error: cant write file '%1'").arg(unpacked.fileName()));
+			outputFile.close();
+			return fatalFail();
+		}
+		resultLen += written;
 	}
 	lzma_end(&stream);
-	if (res != LZMA_OK && res != LZMA_STREAM_END) {
+	outputFile.close();
+	unpacked.close();
+
+	if (res != LZMA_STREAM_END) {
 		const char *msg;
 		switch (res) {
 		case LZMA_MEM_ERROR: msg = "Memory allocation failed"; break;
@@ -344,6 +387,14 @@ void UpdateChecker::unpackUpdate() {
 		}
 		LOG(("Error in decompression: %1 (error code %2)").arg(msg).arg(res));
 		return fatalFail();
+	} else if (resultLen != uncompressedLen) {
+		LOG(("Error in decompression, got %1 bytes instead of %2.").arg(resultLen).arg(uncompressedLen));
+		return fatalFail();
+	}
+
+	if (!unpacked.open(QIODevice::ReadOnly)) {
+		LOG(("Update Error: cant read file '%1'").arg(unpacked.fileName()));
+		return fatalFail();
 	}
 #endif
 
@@ -351,9 +402,7 @@ void UpdateChecker::unpackUpdate() {
 
 	quint32 version;
 	{
-		QBuffer buffer(&uncompressed);
-		buffer.open(QIODevice::ReadOnly);
-		QDataStream stream(&buffer);
+		QDataStream stream(&unpacked);
 		stream.setVersion(QDataStream::Qt_5_1);
 
 		stream >> version;
@@ -390,20 +439,19 @@ void UpdateChecker::unpackUpdate() {
 		}
 		for (uint32 i = 0; i < filesCount; ++i) {
 			QString relativeName;
-			quint32 fileSize;
-			QByteArray fileInnerData;
+			quint32 fileSize, fileInnerDataSize; // file data is a serialized QByteArray, we copy it by UpdateChunk parts
 			bool executable = false;
 
-			stream >> relativeName >> fileSize >> fileInnerData;
-#if defined Q_OS_MAC || defined Q_OS_LINUX
-			stream >> executable;
-#endif
+			stream >> relativeName >> fileSize >> fileInnerDataSize;
 			if (stream.status() != QDataStream::Ok) {
 				LOG(("Update Error: cant read file from downloaded stream, status: %1").arg(stream.status()));
 				return fatalFail();
 			}
-			if (fileSize != quint32(fileInnerData.size())) {
-				LOG(("Update Error: bad file size %1 not matching data size %2").arg(fileSize).arg(fileInnerData.size()));
+			if (fileInnerDataSize == 0xFFFFFFFFU) { // null QByteArray, written by Packer for an empty file
+				fileInnerDataSize = 0;
+			}
+			if (fileSize != fileInnerDataSize) {
+				LOG(("Update Error: bad file size %1 not matching data size %2").arg(fileSize).arg(fileInnerDataSize));
 				return fatalFail();
 			}
 
@@ -416,12 +464,29 @@ void UpdateChecker::unpackUpdate() {
 				LOG(("Update Error: cant open file '%1' for writing").arg(tempDirPath + '/' + relativeName));
 				return fatalFail();
 			}
-			if (f.write(fileInnerData) != fileSize) {
-				f.close();
-				LOG(("Update Error: cant write file '%1'").arg(tempDirPath + '/' + relativeName));
-				return fatalFail();
+			for (quint32 left = fileSize; left > 0;) {
+				QByteArray part = unpacked.read(qMin(left, quint32(UpdateChunk)));
+				if (part.isEmpty()) {
+					f.close();
+					LOG(("Update Error: cant read file '%1' data from downloaded stream").arg(relativeName));
+					return fatalFail();
+				}
+				if (f.write(part) != part.size()) {
+					f.close();
+					LOG(("Update Error: cant write file '%1'").arg(tempDirPath + '/' + relativeName));
+					return fatalFail();
+				}
+				left -= part.size();
 			}
 			f.close();
+
+#if defined Q_OS_MAC || defined Q_OS_LINUX
+			stream >> executable;
+			if (stream.status() != QDataStream::Ok) {
+				LOG(("Update Error: cant read file from downloaded stream, status: %1").arg(stream.status()));
+				return fatalFail();
+			}
+#endif
 			if (executable) {
 				QFileDevice::Permissions p = f.permissions();
 				p |= QFileDevice::ExeOwner | QFileDevice::ExeUser | QFileDevice::ExeGroup | QFileDevice::ExeOther;
@@ -465,7 +530,11 @@ void UpdateChecker::unpackUpdate() {
 		return fatalFail();
 	}
 	outputFile.remove();
+#ifndef Q_OS_WIN
+	unpacked.remove();
+#endif
 
+	LOG(("Update Info: update of %1 bytes downloaded, %2 bytes unpacked in %3ms").arg(compressedLen + hSize).arg(uncompressedLen).arg(getms(true) - unpackStart));
 	Sandbox::updateReady();
 }
 
@@ -42,6 +42,7 @@ enum {
 	MTPAckSendWaiting = 10000, // how much time to wait for some more requests, when sending msg acks
 	MTPResendThreshold = 1, // how much ints should message contain for us not to resend, but to check it's state
 	MTPContainerLives = 600, // container lives 10 minutes in haveSent map
+	MTPDeadlineWheelSlots = 64, // one second slots in the haveSent deadlines wheel, longer deadlines are revisited once per turn
 	MTPMinReceiveDelay = 4000, // 4 seconds
 	MTPMaxReceiveDelay = 64000, // 64 seconds
 	MTPMinConnectDelay = 1000, // tcp connect should take less then 1 second
@@ -49,6 +50,9 @@ enum {
 	MTPConnectionOldTimeout = 192000, // 192 seconds
 	MTPTcpConnectionWaitTimeout = 2000, // 2 seconds waiting for tcp, until we accept http
 	MTPIPv4ConnectionWaitTimeout = 1000, // 1 seconds waiting for ipv4, until we accept ipv6
+	MTPIPv4FailsToSkipWait = 3, // if ipv4 failed that many times in a row for some dc we accept ipv6 right away
+	MTPIPv4SkipsToReprobe = 10, // but after that many connections without waiting we wait for ipv4 once again
+	MTPHttpConcurrentRequests = 2, // http transport keeps up to 2 requests (long-polls) open at once
 	MTPMillerRabinIterCount = 30, // 30 Miller-Rabin iterations for dh_prime primality check
 
 	MTPUploadSessionsCount = 2, // max 2 upload sessions is created
@@ -85,7 +89,11 @@ enum {
 	AnimationTimerDelta = 7,
 	ClipThreadsCount = 8,
 	AverageGifSize = 320 * 240,
+	AverageGifDelay = 100, // load level of a clip is its frame size scaled to 10 frames per second
+	MaxClipLoadLevel = 0x1000000,
 	WaitBeforeGifPause = 200, // wait 200ms for gif draw before pausing it
+	ClipFramesPoolSizeLimit = 32 * 1024 * 1024, // 32 Mb of released gif frame buffers kept for reuse
+	ClipFramesPoolBucketLimit = 6, // max released buffers of the same size kept for reuse
 	InlineBotRequestDelay = 400, // wait 400ms before context bot realtime request
 	RecentInlineBotsLimit = 10,
 
@@ -100,6 +108,7 @@ enum {
 	LinksOverviewPerPage = 12,
 	MediaOverviewStartPerPage = 5,
 	MediaOverviewPreloadCount = 4,
+	MediaOverviewCachedScreens = 1, // overview items keep their pixmaps only within 1 screen above and below the visible one
 
 	AudioVoiceMsgSimultaneously = 4,
 	AudioSongSimultaneously = 4,
@@ -136,6 +145,7 @@ enum {
 	EmojiPanRowsPerPage = 6,
 	StickerPanPerRow = 5,
 	StickerPanRowsPerPage = 4,
+	StickerPanAtlasRows = 8, // each atlas pixmap holds StickerPanPerRow * StickerPanAtlasRows sticker renders
 	SavedGifsMaxPerRow = 4,
 	StickersUpdateTimeout = 3600000, // update not more than once in an hour
 
@@ -344,6 +354,7 @@ enum {
 	MessagesPerPage = 50, // next history part size
 
 	FileLoaderQueueStopTimeout = 5000,
+	FileLoaderQueueThreadsCount = 4, // max threads preparing the sent files in parallel
 
 	DownloadPartSize = 64 * 1024, // 64kb for photo
 	DocumentDownloadPartSize = 128 * 1024, // 128kb for document
@@ -352,6 +363,8 @@ enum {
     UseBigFilesFrom = 10 * 1024 * 1024, // mtp big files methods used for files greater than 10mb
 	MaxFileQueries = 16, // max 16 file parts downloaded at the same time
 	MaxWebFileQueries = 8, // max 8 http[s] files downloaded at the same time
+	MaxFileLoadStreamSize = 64 * 1024 * 1024, // 64mb max file played while downloading
+	FileLoadStreamWaitTimeout = 30000, // 30 seconds waiting for the part of a file being played while downloading
 
 	UploadPartSize = 32 * 1024, // 32kb for photo
     DocumentMaxPartsCount = 3000, // no more than 3000 parts
@@ -370,7 +383,10 @@ enum {
 	WaitForChannelGetDifference = 1000, // 1s wait after show channel history before sending getChannelDifference
 
 	MemoryForImageCache = 64 * 1024 * 1024, // after 64mb of unpacked images we try to clear some memory
+	MemoryForRoundedCache = 16 * 1024 * 1024, // rounded userpics of all images share a 16mb least recently used cache
 	NotifyWindowsCount = 3, // 3 desktop notifies at the same time
+	NotifySoundMinDelay = 1000, // not more than one notify sound in 1 second from all peers
+	NotifyMergeTimeout = 5000, // merge new messages into a notify of the same peer updated less than 5 seconds ago
 	NotifySettingSaveTimeout = 1000, // wait 1 second before saving notify setting to server
 	NotifyDeletePhotoAfter = 60000, // delete notify photo after 1 minute
 	UpdateChunk = 100 * 1024, // 100kb parts when downloading the update
@@ -1389,7 +1389,31 @@ void StickerPanInner::paintStickers(Painter &p, const QRect &r) {
 				if (w < 1) w = 1;
 				if (h < 1) h = 1;
 				QPoint ppos = pos + QPoint((st::stickerPanSize.width() - w) / 2, (st::stickerPanSize.height() - h) / 2);
-				if (goodThumb) {
+				StickersAtlasCells::const_iterator cell = _stickersAtlasCells.constFind(sticker);
+				if (cell == _stickersAtlasCells.cend()) {
+					ImagePtr img = goodThumb ? sticker->thumb : sticker->sticker()->img;
+					if ((goodThumb && img->loaded()) || (!goodThumb && !img->isNull())) {
+						int32 index = _stickersAtlasCells.size(), perAtlas = StickerPanPerRow * StickerPanAtlasRows;
+						if (index / perAtlas >= _stickersAtlases.size()) {
+							QPixmap atlas(StickerPanPerRow * st::stickerPanSize.width() * cIntRetinaFactor(), StickerPanAtlasRows * st::stickerPanSize.height() * cIntRetinaFactor());
+							atlas.fill(Qt::transparent);
+							atlas.setDevicePixelRatio(cRetinaFactor());
+							_stickersAtlases.push_back(atlas);
+						}
+						QPixmap render(img->pixNoCache(w * cIntRetinaFactor(), h * cIntRetinaFactor(), true));
+						render.setDevicePixelRatio(cRetinaFactor());
+						{
+							QRect to(stickerAtlasRect(index, w, h));
+							QPainter atlasPainter(&_stickersAtlases[index / perAtlas]);
+							atlasPainter.setCompositionMode(QPainter::CompositionMode_Source);
+							atlasPainter.drawPixmap(to.x() / cIntRetinaFactor(), to.y() / cIntRetinaFactor(), render);
+						}
+						cell = _stickersAtlasCells.insert(sticker, index);
+					}
+				}
+				if (cell != _stickersAtlasCells.cend()) {
+					p.drawPixmapLeft(ppos, width(), _stickersAtlases.at(cell.value() / (StickerPanPerRow * StickerPanAtlasRows)), stickerAtlasRect(cell.value(), w, h));
+				} else if (goodThumb) {
 					p.drawPixmapLeft(ppos, width(), sticker->thumb->pix(w, h));
 				} else if (!sticker->sticker()->img->isNull()) {
 					p.drawPixmapLeft(ppos, width(), sticker->sticker()->img->pix(w, h));
@@ -1408,6 +1432,17 @@ void StickerPanInner::paintStickers(Painter &p, const QRect &r) {
 	}
 }
 
+QRect StickerPanInner::stickerAtlasRect(int32 cell, int32 w, int32 h) const {
+	int32 inAtlas = cell % (StickerPanPerRow * StickerPanAtlasRows), rf = cIntRetinaFactor();
+	int32 col = inAtlas % StickerPanPerRow, row = inAtlas / StickerPanPerRow;
+	return QRect(col * st::stickerPanSize.width() * rf, row * st::stickerPanSize.height() * rf, w * rf, h * rf);
+}
+
+void StickerPanInner::clearStickersAtlas() {
+	_stickersAtlasCells.clear();
+	_stickersAtlases.clear();
+}
+
 void StickerPanInner::mousePressEvent(QMouseEvent *e) {
 	_lastMousePos = e->globalPos();
 	updateSelected();
@@ -1639,6 +1674,7 @@ void StickerPanInner::hideFinish(bool completely) {
 
 void StickerPanInner::refreshStickers() {
 	clearSelection(true);
+	clearStickersAtlas();
 
 	const StickerSets &sets(cStickerSets());
 	_sets.clear(); _sets.reserve(sets.size() + 1);
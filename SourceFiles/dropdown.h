@@ -405,6 +405,8 @@ private:
 
 	void paintInlineItems(Painter &p, const QRect &r);
 	void paintStickers(Painter &p, const QRect &r);
+	QRect stickerAtlasRect(int32 cell, int32 w, int32 h) const;
+	void clearStickersAtlas();
 
 	int32 _maxHeight;
 
@@ -431,6 +433,11 @@ private:
 	QList<DisplayedSet> _sets;
 	QList<bool> _custom;
 
+	// loaded stickers are rendered in the cell size once and packed to shared pixmaps
+	typedef QMap<DocumentData*, int32> StickersAtlasCells;
+	StickersAtlasCells _stickersAtlasCells;
+	QList<QPixmap> _stickersAtlases;
+
 	bool _showingSavedGifs, _showingInlineItems;
 	bool _setGifCommand;
 	UserData *_inlineBot;
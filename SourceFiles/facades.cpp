@@ -133,6 +133,11 @@ namespace Ui {
 		if (MainWidget *m = App::main()) m->ui_repaintHistoryItem(item);
 	}
 
+	void repaintHistoryItem(const HistoryItem *item, const QRect &rect) {
+		if (!item) return;
+		if (MainWidget *m = App::main()) m->ui_repaintHistoryItem(item, rect);
+	}
+
 	void repaintInlineItem(const LayoutInlineItem *layout) {
 		if (!layout) return;
 		if (MainWidget *m = App::main()) m->ui_repaintInlineItem(layout);
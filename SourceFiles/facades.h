@@ -51,6 +51,7 @@ namespace Ui {
 	bool isInlineItemBeingChosen();
 
 	void repaintHistoryItem(const HistoryItem *item);
+	void repaintHistoryItem(const HistoryItem *item, const QRect &rect); // rect in item coords
 	void repaintInlineItem(const LayoutInlineItem *layout);
 	bool isInlineItemVisible(const LayoutInlineItem *reader);
 
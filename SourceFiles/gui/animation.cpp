@@ -29,6 +29,65 @@ namespace {
 	AnimationManager *_manager = 0;
 	QVector<QThread*> _clipThreads;
 	QVector<ClipReadManager*> _clipManagers;
+
+	class ClipFramesPool { // frame buffers shared between all clip threads, bucketed by size and format
+	public:
+
+		ClipFramesPool() : _size(0) {
+		}
+
+		QImage take(const QSize &size, QImage::Format format) {
+			{
+				QMutexLocker lock(&_mutex);
+				Buckets::iterator i = _buckets.find(bucketKey(size, format));
+				if (i != _buckets.cend() && !i->isEmpty()) {
+					QImage result = i->takeLast();
+					_size -= result.byteCount();
+					return result;
+				}
+			}
+			return QImage(size, format);
+		}
+
+		void release(QImage &image) { // takes buffer only if nobody else (f.e. ClipReader::Frame) references it
+			if (!image.isNull() && image.isDetached()) {
+				QMutexLocker lock(&_mutex);
+				if (_size + image.byteCount() <= ClipFramesPoolSizeLimit) {
+					Images &bucket(_buckets[bucketKey(image.size(), image.format())]);
+					if (bucket.size() < ClipFramesPoolBucketLimit) {
+						bucket.push_back(image);
+						_size += image.byteCount();
+					}
+				}
+			}
+			image = QImage();
+		}
+
+		void clear() {
+			QMutexLocker lock(&_mutex);
+			_buckets.clear();
+			_size = 0;
+		}
+
+	private:
+
+		static uint64 bucketKey(const QSize &size, QImage::Format format) {
+			return (uint64(uint32(size.width())) << 32) | (uint64(uint32(size.height()) & 0xFFFFFFU) << 8) | uint64(uchar(format));
+		}
+
+		typedef QList<QImage> Images;
+		typedef QMap<uint64, Images> Buckets;
+		Buckets _buckets;
+		int32 _size;
+		QMutex _mutex;
+
+	};
+	ClipFramesPool _clipFramesPool;
+
+	int32 clipThreadsCount() {
+		static int32 result = qMax(qMin(QThread::idealThreadCount(), int(ClipThreadsCount)), 2);
+		return result;
+	}
 };
 
 namespace anim {
@@ -101,6 +160,7 @@ namespace anim {
 			_clipThreads.clear();
 			_clipManagers.clear();
 		}
+		_clipFramesPool.clear();
 	}
 
 }
@@ -120,66 +180,104 @@ void Animation::stop() {
 	_manager->stop(this);
 }
 
-AnimationManager::AnimationManager() : _timer(this), _iterating(false) {
-	_timer.setSingleShot(false);
+AnimationManager::AnimationManager() : _timer(this), _frameDuration(AnimationTimerDelta), _nextFrameAt(0), _iterating(false) {
+	_timer.setSingleShot(true);
+	_timer.setTimerType(Qt::PreciseTimer);
 	connect(&_timer, SIGNAL(timeout()), this, SLOT(timeout()));
 }
 
+float64 AnimationManager::frameDuration() const { // one step per screen refresh, but not more often than AnimationTimerDelta
+	QScreen *screen = QGuiApplication::primaryScreen();
+	qreal rate = screen ? screen->refreshRate() : 0;
+	return (rate > 0) ? qMax(float64(AnimationTimerDelta), 1000. / rate) : float64(AnimationTimerDelta);
+}
+
+void AnimationManager::scheduleFrame(uint64 ms) { // frames are kept on a fractional grid, so 60 Hz gives 16.67 ms on average
+	_nextFrameAt += _frameDuration;
+	if (_nextFrameAt < ms) {
+		_nextFrameAt = ms + _frameDuration;
+	}
+	_timer.start(qMax(qRound(_nextFrameAt - ms), 0));
+}
+
 void AnimationManager::start(Animation *obj) {
+	if (_indices.contains(obj)) return;
+
 	if (_iterating) {
-		_starting.insert(obj, NullType());
-		if (!_stopping.isEmpty()) {
-			_stopping.remove(obj);
-		}
+		_indices.insert(obj, -_starting.size() - 1);
+		_starting.push_back(obj);
 	} else {
 		if (_objects.isEmpty()) {
-			_timer.start(AnimationTimerDelta);
+			uint64 ms = getms();
+			_frameDuration = frameDuration();
+			_nextFrameAt = ms;
+			scheduleFrame(ms);
 		}
-		_objects.insert(obj, NullType());
+		_indices.insert(obj, _objects.size());
+		_objects.push_back(obj);
 	}
 }
 
 void AnimationManager::stop(Animation *obj) {
-	if (_iterating) {
-		_stopping.insert(obj, NullType());
-		if (!_starting.isEmpty()) {
-			_starting.remove(obj);
-		}
+	AnimatingIndices::iterator i = _indices.find(obj);
+	if (i == _indices.end()) return;
+
+	int32 index = i.value();
+	_indices.erase(i);
+	if (index < 0) {
+		_starting[-index - 1] = 0;
+	} else if (_iterating) {
+		_objects[index] = 0;
 	} else {
-		AnimatingObjects::iterator i = _objects.find(obj);
-		if (i != _objects.cend()) {
-			_objects.erase(i);
-			if (_objects.isEmpty()) {
-				_timer.stop();
-			}
+		int32 last = _objects.size() - 1;
+		if (index != last) {
+			_objects[index] = _objects.at(last);
+			_indices[_objects.at(index)] = index;
+		}
+		_objects.pop_back();
+		if (_objects.isEmpty()) {
+			_timer.stop();
 		}
 	}
 }
 
 void AnimationManager::timeout() {
+	STATS_TIMER("animation_frame_ms");
+
 	_iterating = true;
 	uint64 ms = getms();
-	for (AnimatingObjects::const_iterator i = _objects.begin(), e = _objects.end(); i != e; ++i) {
-		if (!_stopping.contains(i.key())) {
-			i.key()->step(ms, true);
+	for (int32 i = 0; i < _objects.size(); ++i) {
+		if (Animation *obj = _objects.at(i)) {
+			obj->step(ms, true);
 		}
 	}
 	_iterating = false;
 
-	if (!_starting.isEmpty()) {
-		for (AnimatingObjects::iterator i = _starting.begin(), e = _starting.end(); i != e; ++i) {
-			_objects.insert(i.key(), NullType());
+	int32 size = 0;
+	for (int32 i = 0, l = _objects.size(); i < l; ++i) {
+		if (Animation *obj = _objects.at(i)) {
+			if (i != size) {
+				_objects[size] = obj;
+				_indices[obj] = size;
+			}
+			++size;
 		}
-		_starting.clear();
 	}
-	if (!_stopping.isEmpty()) {
-		for (AnimatingObjects::iterator i = _stopping.begin(), e = _stopping.end(); i != e; ++i) {
-			_objects.remove(i.key());
+	_objects.resize(size);
+	if (!_starting.isEmpty()) {
+		for (int32 i = 0, l = _starting.size(); i < l; ++i) {
+			if (Animation *obj = _starting.at(i)) {
+				_indices[obj] = _objects.size();
+				_objects.push_back(obj);
+			}
 		}
-		_stopping.clear();
+		_starting.clear();
 	}
-	if (!_objects.size()) {
+	STATS_ADD("animation_objects", _objects.size());
+	if (_objects.isEmpty()) {
 		_timer.stop();
+	} else {
+		scheduleFrame(getms());
 	}
 }
 
@@ -194,7 +292,8 @@ QPixmap _prepareFrame(const ClipFrameRequest &request, const QImage &original, b
 		int32 factor(request.factor);
 		bool newcache = (cache.width() != request.outerw || cache.height() != request.outerh);
 		if (newcache) {
-			cache = QImage(request.outerw, request.outerh, QImage::Format_ARGB32_Premultiplied);
+			_clipFramesPool.release(cache);
+			cache = _clipFramesPool.take(QSize(request.outerw, request.outerh), QImage::Format_ARGB32_Premultiplied);
 			cache.setDevicePixelRatio(factor);
 		}
 		{
@@ -239,21 +338,20 @@ ClipReader::ClipReader(const FileLocation &location, const QByteArray &data, Cal
 , _paused(0)
 , _autoplay(false)
 , _private(0) {
-	if (_clipThreads.size() < ClipThreadsCount) {
+	_threadIndex = -1;
+	int32 loadLevel = 0x7FFFFFFF;
+	for (int32 i = 0, l = _clipThreads.size(); i < l; ++i) {
+		int32 level = _clipManagers.at(i)->loadLevel();
+		if (level < loadLevel) {
+			_threadIndex = i;
+			loadLevel = level;
+		}
+	}
+	if (_threadIndex < 0 || (loadLevel > 0 && _clipThreads.size() < clipThreadsCount())) {
 		_threadIndex = _clipThreads.size();
 		_clipThreads.push_back(new QThread());
 		_clipManagers.push_back(new ClipReadManager(_clipThreads.back()));
 		_clipThreads.back()->start();
-	} else {
-		_threadIndex = int32(MTP::nonce<uint32>() % _clipThreads.size());
-		int32 loadLevel = 0x7FFFFFFF;
-		for (int32 i = 0, l = _clipThreads.size(); i < l; ++i) {
-			int32 level = _clipManagers.at(i)->loadLevel();
-			if (level < loadLevel) {
-				_threadIndex = i;
-				loadLevel = level;
-			}
-		}
 	}
 	_clipManagers.at(_threadIndex)->append(this, location, data);
 }
@@ -706,8 +804,9 @@ public:
 		}
 
 		QSize toSize(size.isEmpty() ? QSize(_width, _height) : size);
-		if (to.isNull() || to.size() != toSize) {
-			to = QImage(toSize, QImage::Format_ARGB32);
+		if (to.isNull() || to.size() != toSize || !to.isDetached()) { // never detach-copy a frame still shown by ClipReader
+			_clipFramesPool.release(to);
+			to = _clipFramesPool.take(toSize, QImage::Format_ARGB32);
 		}
 		hasAlpha = (_frame->format == AV_PIX_FMT_BGRA || (_frame->format == -1 && _codecContext->pix_fmt == AV_PIX_FMT_BGRA));
 		if (_frame->width == toSize.width() && _frame->height == toSize.height() && hasAlpha) {
@@ -892,7 +991,10 @@ public:
 	, _width(0)
 	, _height(0)
 	, _nextFrameWhen(0)
-	, _paused(false) {
+	, _paused(false)
+	, _loadLevel(AverageGifSize)
+	, _framesRendered(0)
+	, _framesDropped(0) {
 		if (_data.isEmpty() && !_location->accessEnable()) {
 			error();
 			return;
@@ -932,12 +1034,18 @@ public:
 	}
 
 	ClipProcessResult finishProcess(uint64 ms) {
+		STATS_TIMER("clip_frame_ms");
 		if (!readNextFrame()) {
 			return error();
 		}
-		if (ms >= _nextFrameWhen && !readNextFrame(true)) {
-			return error();
+		if (ms >= _nextFrameWhen) { // we are late, skip one frame to keep up
+			++_framesDropped;
+			STATS_ADD("clip_frames_dropped", 1);
+			if (!readNextFrame(true)) {
+				return error();
+			}
 		}
+		++_framesRendered;
 		if (!renderFrame()) {
 			return error();
 		}
@@ -949,6 +1057,13 @@ public:
 		return qMax(delay, 5);
 	}
 
+	int32 loadLevel() const { // pixels per AverageGifDelay while playing, paused readers cost nothing
+		if (_paused) return 0;
+		if (_width <= 0 || _height <= 0 || !_implementation) return AverageGifSize;
+		int64 delay = qMax(_implementation->nextFrameDelay(), 5);
+		return int32(qMin(int64(_width) * _height * AverageGifDelay / delay, int64(MaxClipLoadLevel)));
+	}
+
 	bool readNextFrame(bool keepup = false) {
 		if (!_implementation->readNextFrame()) {
 			return false;
@@ -994,6 +1109,14 @@ public:
 		return ClipProcessError;
 	}
 
+	void releaseFrames() { // paused or finished reader gives its buffers to the shared pool
+		for (int32 i = 0; i < 3; ++i) {
+			_frames[i].pix = QPixmap();
+			_clipFramesPool.release(_frames[i].original);
+			_clipFramesPool.release(_frames[i].cache);
+		}
+	}
+
 	void stop() {
 		delete _implementation;
 		_implementation = 0;
@@ -1010,6 +1133,7 @@ public:
 
 	~ClipReaderPrivate() {
 		stop();
+		releaseFrames();
 		deleteAndMark(_location);
 		deleteAndMark(_implementation);
 		_data.clear();
@@ -1048,6 +1172,9 @@ private:
 
 	bool _paused;
 
+	int32 _loadLevel; // accounted in ClipReadManager::_loadLevel
+	int32 _framesRendered, _framesDropped;
+
 	friend class ClipReadManager;
 
 };
@@ -1135,9 +1262,6 @@ bool ClipReadManager::handleProcessResult(ClipReaderPrivate *reader, ClipProcess
 		return false;
 	}
 
-	if (result == ClipProcessStarted) {
-		_loadLevel.fetchAndAddRelaxed(reader->_width * reader->_height - AverageGifSize);
-	}
 	if (!reader->_paused && result == ClipProcessRepaint) {
 		int32 ishowing, iprevious;
 		ClipReader::Frame *showing = it.key()->frameToShow(&ishowing), *previous = it.key()->frameToWriteNext(false, &iprevious);
@@ -1150,6 +1274,9 @@ bool ClipReadManager::handleProcessResult(ClipReaderPrivate *reader, ClipProcess
 			}
 		}
 	}
+	if (result == ClipProcessStarted || result == ClipProcessCopyFrame || result == ClipProcessPaused) {
+		updateLoadLevel(reader);
+	}
 	if (result == ClipProcessStarted || result == ClipProcessCopyFrame) {
 		t_assert(reader->_frame >= 0);
 		ClipReader::Frame *frame = it.key()->_frames + reader->_frame;
@@ -1163,6 +1290,7 @@ bool ClipReadManager::handleProcessResult(ClipReaderPrivate *reader, ClipProcess
 			emit callback(it.key(), it.key()->threadIndex(), ClipReaderReinit);
 		}
 	} else if (result == ClipProcessPaused) {
+		reader->releaseFrames(); // frames still referenced by ClipReader are not taken by the pool
 		it.key()->moveToNextWrite();
 		emit callback(it.key(), it.key()->threadIndex(), ClipReaderReinit);
 	} else if (result == ClipProcessRepaint) {
@@ -1172,9 +1300,20 @@ bool ClipReadManager::handleProcessResult(ClipReaderPrivate *reader, ClipProcess
 	return true;
 }
 
+void ClipReadManager::updateLoadLevel(ClipReaderPrivate *reader) {
+	int32 level = reader->loadLevel();
+	if (level != reader->_loadLevel) {
+		_loadLevel.fetchAndAddRelaxed(level - reader->_loadLevel);
+		reader->_loadLevel = level;
+	}
+}
+
 ClipReadManager::ResultHandleState ClipReadManager::handleResult(ClipReaderPrivate *reader, ClipProcessResult result, uint64 ms) {
 	if (!handleProcessResult(reader, result, ms)) {
-		_loadLevel.fetchAndAddRelaxed(-1 * (reader->_width > 0 ? reader->_width * reader->_height : AverageGifSize));
+		_loadLevel.fetchAndAddRelaxed(-reader->_loadLevel);
+		if (reader->_framesDropped) {
+			DEBUG_LOG(("Clip Info: reader finished, frames rendered %1, dropped %2").arg(reader->_framesRendered).arg(reader->_framesDropped));
+		}
 		delete reader;
 		return ResultHandleRemove;
 	}
@@ -1227,6 +1366,7 @@ void ClipReadManager::process() {
 					i.value() = ms;
 					if (i.key()->_paused && !it.key()->_paused.loadAcquire()) {
 						i.key()->_paused = false;
+						updateLoadLevel(i.key());
 					}
 				}
 				ClipReader::Frame *frame = it.key()->frameToWrite();
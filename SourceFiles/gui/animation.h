@@ -465,9 +465,15 @@ public slots:
 	void clipCallback(ClipReader *reader, qint32 threadIndex, qint32 notification);
 
 private:
-	typedef QMap<Animation*, NullType> AnimatingObjects;
-	AnimatingObjects _objects, _starting, _stopping;
+	float64 frameDuration() const;
+	void scheduleFrame(uint64 ms);
+
+	typedef QVector<Animation*> AnimatingObjects;
+	AnimatingObjects _objects, _starting; // stopped while iterating are set to null
+	typedef QHash<Animation*, int32> AnimatingIndices; // index in _objects or -(index in _starting) - 1
+	AnimatingIndices _indices;
 	QTimer _timer;
+	float64 _frameDuration, _nextFrameAt;
 	bool _iterating;
 
 };
@@ -648,6 +654,7 @@ private:
 	ReaderPointers::iterator unsafeFindReaderPointer(ClipReaderPrivate *reader);
 
 	bool handleProcessResult(ClipReaderPrivate *reader, ClipProcessResult result, uint64 ms);
+	void updateLoadLevel(ClipReaderPrivate *reader);
 
 	enum ResultHandleState {
 		ResultHandleRemove,
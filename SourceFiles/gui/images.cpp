@@ -47,6 +47,19 @@ namespace {
 	static const uint64 ColoredCacheSkip = 0x2000000000000000LLU;
 	static const uint64 BlurredColoredCacheSkip = 0x3000000000000000LLU;
 	static const uint64 RoundedCacheSkip = 0x4000000000000000LLU;
+	static const uint64 CacheSkipMask = 0xF000000000000000LLU;
+
+	typedef QPair<const Image*, uint64> RoundedCacheKey;
+	typedef QMap<uint64, RoundedCacheKey> RoundedCacheOrder; // use tick -> entry, oldest first
+	typedef QHash<RoundedCacheKey, uint64> RoundedCacheTicks;
+	RoundedCacheOrder roundedCacheOrder;
+	RoundedCacheTicks roundedCacheTicks;
+	uint64 roundedCacheTick = 0;
+	int64 roundedCacheSize = 0;
+
+	inline int64 pixSize(const QPixmap &p) {
+		return p.isNull() ? 0 : (int64(p.width()) * p.height() * 4);
+	}
 }
 
 StorageImageLocation StorageImageLocation::Null;
@@ -105,6 +118,7 @@ const QPixmap &Image::pix(int32 w, int32 h) const {
     }
 	uint64 k = (uint64(w) << 32) | uint64(h);
 	Sizes::const_iterator i = _sizesCache.constFind(k);
+	STATS_ADD((i == _sizesCache.cend()) ? "image_pix_cache_miss" : "image_pix_cache_hit", 1);
 	if (i == _sizesCache.cend()) {
 		QPixmap p(pixNoCache(w, h, true));
         if (cRetina()) p.setDevicePixelRatio(cRetinaFactor());
@@ -127,6 +141,7 @@ const QPixmap &Image::pixRounded(int32 w, int32 h) const {
 	}
 	uint64 k = RoundedCacheSkip | (uint64(w) << 32) | uint64(h);
 	Sizes::const_iterator i = _sizesCache.constFind(k);
+	STATS_ADD((i == _sizesCache.cend()) ? "image_pix_cache_miss" : "image_pix_cache_hit", 1);
 	if (i == _sizesCache.cend()) {
 		QPixmap p(pixNoCache(w, h, true, false, true));
 		if (cRetina()) p.setDevicePixelRatio(cRetinaFactor());
@@ -135,9 +150,49 @@ const QPixmap &Image::pixRounded(int32 w, int32 h) const {
 			globalAcquiredSize += int64(p.width()) * p.height() * 4;
 		}
 	}
+	roundedUsed(k);
 	return i.value();
 }
 
+void Image::roundedUsed(uint64 k) const {
+	RoundedCacheKey key(this, k);
+	RoundedCacheTicks::iterator i = roundedCacheTicks.find(key);
+	if (i == roundedCacheTicks.end()) {
+		i = roundedCacheTicks.insert(key, 0);
+		roundedCacheSize += pixSize(_sizesCache.value(k));
+	} else {
+		roundedCacheOrder.remove(i.value());
+	}
+	i.value() = ++roundedCacheTick;
+	roundedCacheOrder.insert(i.value(), key);
+
+	while (roundedCacheSize > MemoryForRoundedCache && roundedCacheOrder.size() > 1) { // the just used entry is last, never evicted
+		RoundedCacheOrder::iterator j = roundedCacheOrder.begin();
+		const Image *img = j.value().first;
+		uint64 evicted = j.value().second;
+		roundedCacheTicks.remove(j.value());
+		roundedCacheOrder.erase(j);
+
+		Sizes::iterator s = img->_sizesCache.find(evicted);
+		if (s != img->_sizesCache.end()) {
+			int64 size = pixSize(s.value());
+			globalAcquiredSize -= size;
+			roundedCacheSize -= size;
+			img->_sizesCache.erase(s);
+		}
+		STATS_ADD("image_rounded_cache_evicted", 1);
+	}
+}
+
+void Image::roundedRemoved(uint64 k, int64 size) const {
+	RoundedCacheTicks::iterator i = roundedCacheTicks.find(RoundedCacheKey(this, k));
+	if (i != roundedCacheTicks.end()) {
+		roundedCacheOrder.remove(i.value());
+		roundedCacheTicks.erase(i);
+		roundedCacheSize -= size;
+	}
+}
+
 const QPixmap &Image::pixBlurred(int32 w, int32 h) const {
 	checkload();
 
@@ -149,6 +204,7 @@ const QPixmap &Image::pixBlurred(int32 w, int32 h) const {
 	}
 	uint64 k = BlurredCacheSkip | (uint64(w) << 32) | uint64(h);
 	Sizes::const_iterator i = _sizesCache.constFind(k);
+	STATS_ADD((i == _sizesCache.cend()) ? "image_pix_cache_miss" : "image_pix_cache_hit", 1);
 	if (i == _sizesCache.cend()) {
 		QPixmap p(pixNoCache(w, h, true, true));
 		if (cRetina()) p.setDevicePixelRatio(cRetinaFactor());
@@ -171,6 +227,7 @@ const QPixmap &Image::pixColored(const style::color &add, int32 w, int32 h) cons
 	}
 	uint64 k = ColoredCacheSkip | (uint64(w) << 32) | uint64(h);
 	Sizes::const_iterator i = _sizesCache.constFind(k);
+	STATS_ADD((i == _sizesCache.cend()) ? "image_pix_cache_miss" : "image_pix_cache_hit", 1);
 	if (i == _sizesCache.cend()) {
 		QPixmap p(pixColoredNoCache(add, w, h, true));
 		if (cRetina()) p.setDevicePixelRatio(cRetinaFactor());
@@ -193,6 +250,7 @@ const QPixmap &Image::pixBlurredColored(const style::color &add, int32 w, int32
 	}
 	uint64 k = BlurredColoredCacheSkip | (uint64(w) << 32) | uint64(h);
 	Sizes::const_iterator i = _sizesCache.constFind(k);
+	STATS_ADD((i == _sizesCache.cend()) ? "image_pix_cache_miss" : "image_pix_cache_hit", 1);
 	if (i == _sizesCache.cend()) {
 		QPixmap p(pixBlurredColoredNoCache(add, w, h));
 		if (cRetina()) p.setDevicePixelRatio(cRetinaFactor());
@@ -580,6 +638,9 @@ void Image::restore() const {
 
 void Image::invalidateSizeCache() const {
 	for (Sizes::const_iterator i = _sizesCache.cbegin(), e = _sizesCache.cend(); i != e; ++i) {
+		if ((i.key() & CacheSkipMask) == RoundedCacheSkip) {
+			roundedRemoved(i.key(), pixSize(i.value()));
+		}
 		if (!i->isNull()) {
 			globalAcquiredSize -= int64(i->width()) * i->height() * 4;
 		}
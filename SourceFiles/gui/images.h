@@ -220,6 +220,9 @@ private:
 	typedef QMap<uint64, QPixmap> Sizes;
 	mutable Sizes _sizesCache;
 
+	void roundedUsed(uint64 k) const;
+	void roundedRemoved(uint64 k, int64 size) const;
+
 };
 
 Image *getImage(const QString &file, QByteArray format);
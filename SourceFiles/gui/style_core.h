@@ -236,10 +236,10 @@ namespace style {
 	typedef QVector<QString> FontFamilies;
 	extern FontFamilies _fontFamilies;
 
-	typedef QMap<uint32, FontData*> FontDatas;
+	typedef QHash<uint32, FontData*> FontDatas;
 	extern FontDatas _fontsMap;
 
-	typedef QMap<uint32, ColorData*> ColorDatas;
+	typedef QHash<uint32, ColorData*> ColorDatas;
 	extern ColorDatas _colorsMap;
 
 	extern int _spriteWidth;
@@ -301,6 +301,7 @@ History::History(const PeerId &peerId) : width(0), height(0)
 	}
 	for (int32 i = 0; i < OverviewCount; ++i) {
 		overviewCountData[i] = -1; // not loaded yet
+		overviewSortedCount[i] = 0;
 	}
 }
 
@@ -1678,8 +1679,8 @@ bool History::addToOverview(MediaOverviewType type, MsgId msgId, AddToOverviewMe
 	overviewIds[type].insert(msgId, NullType());
 	switch (method) {
 	case AddToOverviewNew:
-	case AddToOverviewBack: overview[type].push_back(msgId); break;
-	case AddToOverviewFront: overview[type].push_front(msgId); break;
+	case AddToOverviewBack: overview[type].push_back(msgId); overviewSortedExtend(type); break;
+	case AddToOverviewFront: overview[type].push_front(msgId); overviewPushedFront(type); break;
 	}
 	if (method == AddToOverviewNew) {
 		if (overviewCountData[type] > 0) {
@@ -1696,19 +1697,66 @@ void History::eraseFromOverview(MediaOverviewType type, MsgId msgId) {
 	History::MediaOverviewIds::iterator i = overviewIds[type].find(msgId);
 	if (i == overviewIds[type].cend()) return;
 
+	int32 index = overviewIndexOf(type, msgId);
 	overviewIds[type].erase(i);
-	for (History::MediaOverview::iterator i = overview[type].begin(), e = overview[type].end(); i != e; ++i) {
-		if ((*i) == msgId) {
-			overview[type].erase(i);
-			if (overviewCountData[type] > 0) {
-				--overviewCountData[type];
-			}
-			break;
+	if (index >= 0) {
+		overview[type].removeAt(index);
+		if (index < overviewSortedCount[type]) {
+			--overviewSortedCount[type];
+		}
+		overviewSortedExtend(type);
+		if (overviewCountData[type] > 0) {
+			--overviewCountData[type];
 		}
 	}
 	if (App::wnd()) App::wnd()->mediaOverviewUpdated(peer, type);
 }
 
+int32 History::overviewIndexOf(int32 overviewIndex, MsgId msgId) const {
+	const MediaOverview &o(overview[overviewIndex]);
+	if (overviewIds[overviewIndex].constFind(msgId) == overviewIds[overviewIndex].cend()) return -1;
+
+	// binary search only in the ascending prefix, the unordered tail is usually a few sending messages
+	int32 sorted = overviewSortedCount[overviewIndex];
+	if (msgId > 0 && sorted > 0) {
+		MediaOverview::const_iterator b = o.cbegin(), e = b + sorted;
+		MediaOverview::const_iterator i = std::lower_bound(b, e, msgId);
+		if (i != e && *i == msgId) {
+			return i - b;
+		}
+	}
+	for (int32 i = o.size(); i > sorted;) {
+		if (o.at(--i) == msgId) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+void History::overviewPushedFront(int32 overviewIndex) {
+	const MediaOverview &o(overview[overviewIndex]);
+	int32 &sorted(overviewSortedCount[overviewIndex]);
+	if (o.front() <= 0) {
+		sorted = 0;
+	} else if (sorted > 0 && o.front() < o.at(1)) {
+		++sorted;
+	} else {
+		sorted = 1;
+	}
+	overviewSortedExtend(overviewIndex);
+}
+
+void History::overviewSortedExtend(int32 overviewIndex) {
+	const MediaOverview &o(overview[overviewIndex]);
+	int32 &sorted(overviewSortedCount[overviewIndex]);
+	if (!sorted && !o.isEmpty() && o.front() > 0) {
+		sorted = 1;
+	}
+	while (sorted > 0 && sorted < o.size() && o.at(sorted) > o.at(sorted - 1)) {
+		++sorted;
+	}
+}
+
 HistoryItem *History::addNewItem(HistoryBlock *to, bool newBlock, HistoryItem *adding, bool newMsg) {
 	if (!adding) {
 		if (newBlock) delete to;
@@ -1900,6 +1948,8 @@ HistoryItem *History::addMessageGroupAfterPrev(HistoryItem *newItem, HistoryItem
 }
 
 void History::addOlderSlice(const QVector<MTPMessage> &slice, const QVector<MTPMessageGroup> *collapsed) {
+	STATS_TIMER("history_older_slice_ms");
+	STATS_ADD("history_older_slice_msgs", slice.size());
 	if (slice.isEmpty()) {
 		oldLoaded = true;
 		if (!collapsed || collapsed->isEmpty() || !isChannel()) {
@@ -2128,6 +2178,7 @@ void History::addNewerSlice(const QVector<MTPMessage> &slice, const QVector<MTPM
 			if (!overview[i].isEmpty() || !overviewIds[i].isEmpty()) {
 				overview[i].clear();
 				overviewIds[i].clear();
+				overviewSortedCount[i] = 0;
 				mask |= (1 << i);
 			}
 		}
@@ -2544,6 +2595,7 @@ void History::clear(bool leaveItems) {
 			}
 			overview[i].clear();
 			overviewIds[i].clear();
+			overviewSortedCount[i] = 0;
 			if (App::wnd() && !App::quitting()) App::wnd()->mediaOverviewUpdated(peer, MediaOverviewType(i));
 		}
 	}
@@ -2682,6 +2734,7 @@ void History::overviewSliceDone(int32 overviewIndex, const MTPmessages_Messages
 		if (item && overviewIds[overviewIndex].constFind(item->id) == overviewIds[overviewIndex].cend()) {
 			overviewIds[overviewIndex].insert(item->id, NullType());
 			overview[overviewIndex].push_front(item->id);
+			overviewPushedFront(overviewIndex);
 		}
 	}
 }
@@ -2690,18 +2743,25 @@ void History::changeMsgId(MsgId oldId, MsgId newId) {
 	for (int32 i = 0; i < OverviewCount; ++i) {
 		History::MediaOverviewIds::iterator j = overviewIds[i].find(oldId);
 		if (j != overviewIds[i].cend()) {
+			int32 index = overviewIndexOf(i, oldId);
 			overviewIds[i].erase(j);
-			int32 index = overview[i].indexOf(oldId);
 			if (overviewIds[i].constFind(newId) == overviewIds[i].cend()) {
 				overviewIds[i].insert(newId, NullType());
 				if (index >= 0) {
 					overview[i][index] = newId;
+					if (index < overviewSortedCount[i]) {
+						overviewSortedCount[i] = index;
+					}
 				} else {
 					overview[i].push_back(newId);
 				}
 			} else if (index >= 0) {
 				overview[i].removeAt(index);
+				if (index < overviewSortedCount[i]) {
+					--overviewSortedCount[i];
+				}
 			}
+			overviewSortedExtend(i);
 		}
 	}
 }
@@ -3050,12 +3110,16 @@ void HistoryItem::clipCallback(ClipReaderNotification notification) {
 
 	case ClipReaderRepaint: {
 		if (!reader->currentDisplayed()) {
-			Ui::repaintHistoryItem(this);
+			repaintMedia(media);
 		}
 	} break;
 	}
 }
 
+void HistoryItem::repaintMedia(const HistoryMedia *media, const QRect &rect) const {
+	Ui::repaintHistoryItem(this);
+}
+
 HistoryItem::~HistoryItem() {
 	App::historyUnregItem(this);
 	if (id < 0 && App::uploader()) {
@@ -3220,16 +3284,17 @@ void HistoryFileMedia::step_thumbOver(const HistoryItem *parent, float64 ms, boo
 		_animation->a_thumbOver.update(dt, anim::linear);
 	}
 	if (timer) {
-		Ui::repaintHistoryItem(parent);
+		parent->repaintMedia(this, _animation ? _animation->rect : QRect());
 	}
 }
 
 void HistoryFileMedia::step_radial(const HistoryItem *parent, uint64 ms, bool timer) {
 	if (timer) {
-		Ui::repaintHistoryItem(parent);
+		parent->repaintMedia(this, _animation->rect);
 	} else {
 		_animation->radial.update(dataProgress(), dataFinished(), ms);
 		if (!_animation->radial.animating()) {
+			Ui::repaintHistoryItem(parent); // icon and status outside of the radial rect change as well
 			checkAnimationFinished();
 		}
 	}
@@ -3424,6 +3489,7 @@ void HistoryPhoto::draw(Painter &p, const HistoryItem *parent, const QRect &r, b
 	if (notChild && (radial || (!loaded && !_data->loading()))) {
 		float64 radialOpacity = (radial && loaded && !_data->uploading()) ? _animation->radial.opacity() : 1;
 		QRect inner(rthumb.x() + (rthumb.width() - st::msgFileSize) / 2, rthumb.y() + (rthumb.height() - st::msgFileSize) / 2, st::msgFileSize, st::msgFileSize);
+		if (_animation) _animation->rect = inner;
 		p.setPen(Qt::NoPen);
 		if (selected) {
 			p.setBrush(st::msgDateImgBgSelected);
@@ -3727,6 +3793,7 @@ void HistoryVideo::draw(Painter &p, const HistoryItem *parent, const QRect &r, b
 	}
 
 	QRect inner(rthumb.x() + (rthumb.width() - st::msgFileSize) / 2, rthumb.y() + (rthumb.height() - st::msgFileSize) / 2, st::msgFileSize, st::msgFileSize);
+	if (_animation) _animation->rect = inner;
 	p.setPen(Qt::NoPen);
 	if (selected) {
 		p.setBrush(st::msgDateImgBgSelected);
@@ -4059,6 +4126,7 @@ void HistoryDocument::draw(Painter &p, const HistoryItem *parent, const QRect &r
 		if (radial || (!loaded && !_data->loading())) {
             float64 radialOpacity = (radial && loaded && !_data->uploading()) ? _animation->radial.opacity() : 1;
 			QRect inner(rthumb.x() + (rthumb.width() - st::msgFileSize) / 2, rthumb.y() + (rthumb.height() - st::msgFileSize) / 2, st::msgFileSize, st::msgFileSize);
+			if (_animation) _animation->rect = inner;
 			p.setPen(Qt::NoPen);
 			if (selected) {
 				p.setBrush(st::msgDateImgBgSelected);
@@ -4108,6 +4176,7 @@ void HistoryDocument::draw(Painter &p, const HistoryItem *parent, const QRect &r
 		bottom = st::msgFilePadding.top() + st::msgFileSize + st::msgFilePadding.bottom();
 
 		QRect inner(rtlrect(st::msgFilePadding.left(), st::msgFilePadding.top(), st::msgFileSize, st::msgFileSize, _width));
+		if (_animation) _animation->rect = inner;
 		p.setPen(Qt::NoPen);
 		if (selected) {
 			p.setBrush(outbg ? st::msgFileOutBgSelected : st::msgFileInBgSelected);
@@ -4657,6 +4726,7 @@ void HistoryGif::draw(Painter &p, const HistoryItem *parent, const QRect &r, boo
 	if (radial || (!_gif && ((!loaded && !_data->loading()) || !cAutoPlayGif())) || (_gif == BadClipReader)) {
         float64 radialOpacity = (radial && loaded && parent->id > 0) ? _animation->radial.opacity() : 1;
 		QRect inner(rthumb.x() + (rthumb.width() - st::msgFileSize) / 2, rthumb.y() + (rthumb.height() - st::msgFileSize) / 2, st::msgFileSize, st::msgFileSize);
+		if (_animation) _animation->rect = inner;
 		p.setPen(Qt::NoPen);
 		if (selected) {
 			p.setBrush(st::msgDateImgBgSelected);
@@ -6657,6 +6727,20 @@ void HistoryMessage::setId(MsgId newId) {
 	}
 }
 
+void HistoryMessage::repaintMedia(const HistoryMedia *media, const QRect &rect) const {
+	if (!_media || media != _media || !_media->isDisplayed()) {
+		return HistoryItem::repaintMedia(media, rect);
+	}
+
+	int32 left = 0, width = 0;
+	countPositionAndSize(left, width);
+	if (width < 1) return;
+
+	int32 top = drawBubble() ? (_height - st::msgMargin.bottom() - _media->height()) : st::msgMargin.top();
+	QRect r(rect.isEmpty() ? QRect(0, 0, _media->currentWidth(), _media->height()) : rect);
+	Ui::repaintHistoryItem(this, r.translated(left, top));
+}
+
 void HistoryMessage::draw(Painter &p, const QRect &r, uint32 selection, uint64 ms) const {
 	bool outbg = out() && !isPost(), bubble = drawBubble(), selected = (selection == FullSelection);
 
@@ -415,13 +415,10 @@ public:
 		return result;
 	}
 	MsgId overviewMinId(int32 overviewIndex) const {
-		for (MediaOverviewIds::const_iterator i = overviewIds[overviewIndex].cbegin(), e = overviewIds[overviewIndex].cend(); i != e; ++i) {
-			if (i.key() > 0) {
-				return i.key();
-			}
-		}
-		return 0;
+		MediaOverviewIds::const_iterator i = overviewIds[overviewIndex].lowerBound(1);
+		return (i == overviewIds[overviewIndex].cend()) ? 0 : i.key();
 	}
+	int32 overviewIndexOf(int32 overviewIndex, MsgId msgId) const; // -1 if not found
 	void overviewSliceDone(int32 overviewIndex, const MTPmessages_Messages &result, bool onlyCounts = false);
 	bool overviewHasMsgId(int32 overviewIndex, MsgId msgId) const {
 		return overviewIds[overviewIndex].constFind(msgId) != overviewIds[overviewIndex].cend();
@@ -437,6 +434,9 @@ private:
 	typedef QMap<MsgId, NullType> MediaOverviewIds;
 	MediaOverviewIds overviewIds[OverviewCount];
 	int32 overviewCountData[OverviewCount]; // -1 - not loaded, 0 - all loaded, > 0 - count, but not all loaded
+	int32 overviewSortedCount[OverviewCount]; // overview[i] starts with this many ascending server ids, the rest (sending or sent after them) is unordered
+	void overviewPushedFront(int32 overviewIndex);
+	void overviewSortedExtend(int32 overviewIndex);
 
 	friend class HistoryBlock;
 	friend class ChannelHistory;
@@ -925,6 +925,13 @@ public:
 
 	HistoryItem(History *history, HistoryBlock *block, MsgId msgId, int32 flags, QDateTime msgDate, int32 from);
 
+	static void *operator new(size_t size) {
+		return SlabAlloc(size);
+	}
+	static void operator delete(void *p, size_t size) {
+		SlabFree(p, size);
+	}
+
 	virtual void initDimensions() = 0;
 	virtual int32 resize(int32 width) = 0; // return new height
 	virtual void draw(Painter &p, const QRect &r, uint32 selection, uint64 ms) const = 0;
@@ -1123,6 +1130,7 @@ public:
 	virtual HistoryMedia *getMedia(bool inOverview = false) const {
 		return 0;
 	}
+	virtual void repaintMedia(const HistoryMedia *media, const QRect &rect = QRect()) const; // rect in media coords, empty for the whole media
 	virtual void setText(const QString &text, const EntitiesInText &links) {
 	}
 	virtual QString originalText() const {
@@ -1446,6 +1454,7 @@ protected:
 		Animation _a_thumbOver;
 
 		RadialAnimation radial;
+		QRect rect; // where the thumb over and radial were last painted
 	};
 	mutable AnimationData *_animation;
 
@@ -2147,6 +2156,7 @@ public:
 	void setViewsCount(int32 count, bool reinit = true);
 	void setId(MsgId newId);
 	void draw(Painter &p, const QRect &r, uint32 selection, uint64 ms) const;
+	void repaintMedia(const HistoryMedia *media, const QRect &rect = QRect()) const;
 
 	virtual void drawMessageText(Painter &p, QRect trect, uint32 selection) const;
 
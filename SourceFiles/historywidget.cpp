@@ -122,8 +122,17 @@ void HistoryInner::repaintItem(const HistoryItem *item) {
 	}
 }
 
+void HistoryInner::repaintItem(const HistoryItem *item, const QRect &rect) {
+	if (!item || item->detached() || !_history) return;
+	int32 msgy = itemTop(item);
+	if (msgy >= 0) {
+		update(rect.intersected(QRect(0, 0, width(), item->height())).translated(0, msgy));
+	}
+}
+
 void HistoryInner::paintEvent(QPaintEvent *e) {
 	if (App::wnd() && App::wnd()->contentOverlapped(this, e)) return;
+	STATS_TIMER("history_paint_ms");
 
 	if (!App::main()) return;
 
@@ -134,6 +143,7 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 		p.setClipRect(r);
 	}
 	uint64 ms = getms();
+	STATS_ADD("history_paint_pixels", r.width() * r.height());
 
 	if (!_firstLoading && _botInfo && !_botInfo->text.isEmpty() && _botDescHeight > 0) {
 		if (r.y() < _botDescRect.y() + _botDescRect.height() && r.y() + r.height() > _botDescRect.y()) {
@@ -2717,7 +2727,7 @@ HistoryWidget::HistoryWidget(QWidget *parent) : TWidget(parent)
 , _attachDrag(DragStateNone)
 , _attachDragDocument(this)
 , _attachDragPhoto(this)
-, _fileLoader(this, FileLoaderQueueStopTimeout)
+, _fileLoader(this, FileLoaderQueueStopTimeout, qMin(QThread::idealThreadCount(), int(FileLoaderQueueThreadsCount)))
 , _textUpdateEventsFlags(TextUpdateEventsSaveDraft | TextUpdateEventsSendTyping)
 , _serviceImageCacheSize(0)
 , _confirmWithTextId(0)
@@ -6153,6 +6163,17 @@ void HistoryWidget::ui_repaintHistoryItem(const HistoryItem *item) {
 	}
 }
 
+void HistoryWidget::ui_repaintHistoryItem(const HistoryItem *item, const QRect &rect) {
+	if (_peer && _list && (item->history() == _history || (_migrated && item->history() == _migrated))) {
+		uint64 ms = getms();
+		if (_lastScrolled + 100 <= ms) {
+			_list->repaintItem(item, rect);
+		} else {
+			_updateHistoryItems.start(_lastScrolled + 100 - ms);
+		}
+	}
+}
+
 void HistoryWidget::onUpdateHistoryItems() {
 	if (!_list) return;
 
@@ -70,6 +70,7 @@ public:
 	void updateSize();
 
 	void repaintItem(const HistoryItem *item);
+	void repaintItem(const HistoryItem *item, const QRect &rect);
 
 	bool canCopySelected() const;
 	bool canDeleteSelected() const;
@@ -584,6 +585,7 @@ public:
 	bool isItemVisible(HistoryItem *item);
 
 	void ui_repaintHistoryItem(const HistoryItem *item);
+	void ui_repaintHistoryItem(const HistoryItem *item, const QRect &rect);
 	void ui_repaintInlineItem(const LayoutInlineItem *gif);
 	bool ui_isInlineItemVisible(const LayoutInlineItem *layout);
 	bool ui_isInlineItemBeingChosen();
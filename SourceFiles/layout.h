@@ -133,6 +133,8 @@ public:
 	}
 	virtual void linkOut(const TextLinkPtr &lnk) {
 	}
+	virtual void clearCache() const { // free cached pixmaps, they are prepared again in paint()
+	}
 
 	int32 width() const {
 		return _width;
@@ -305,6 +307,9 @@ public:
 	virtual int32 resizeGetHeight(int32 width);
 	virtual void paint(Painter &p, const QRect &clip, uint32 selection, const PaintContext *context) const;
 	virtual void getState(TextLinkPtr &link, HistoryCursorState &cursor, int32 x, int32 y) const;
+	virtual void clearCache() const {
+		_pix = QPixmap();
+	}
 
 private:
 	PhotoData *_data;
@@ -323,6 +328,9 @@ public:
 	virtual int32 resizeGetHeight(int32 width);
 	virtual void paint(Painter &p, const QRect &clip, uint32 selection, const PaintContext *context) const;
 	virtual void getState(TextLinkPtr &link, HistoryCursorState &cursor, int32 x, int32 y) const;
+	virtual void clearCache() const {
+		_pix = QPixmap();
+	}
 
 protected:
 	virtual float64 dataProgress() const {
@@ -390,6 +398,9 @@ public:
 	virtual void initDimensions();
 	virtual void paint(Painter &p, const QRect &clip, uint32 selection, const PaintContext *context) const;
 	virtual void getState(TextLinkPtr &link, HistoryCursorState &cursor, int32 x, int32 y) const;
+	virtual void clearCache() const {
+		_thumb = QPixmap();
+	}
 
 	virtual DocumentData *getDocument() const {
 		return _data;
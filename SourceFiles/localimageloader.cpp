@@ -29,7 +29,7 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 #include "lang.h"
 #include "boxes/confirmbox.h"
 
-TaskQueue::TaskQueue(QObject *parent, int32 stopTimeoutMs) : QObject(parent), _thread(0), _worker(0), _stopTimer(0) {
+TaskQueue::TaskQueue(QObject *parent, int32 stopTimeoutMs, int32 threadsCount) : QObject(parent), _threadsCount(qMax(threadsCount, 1)), _stopTimer(0) {
 	if (stopTimeoutMs > 0) {
 		_stopTimer = new QTimer(this);
 		connect(_stopTimer, SIGNAL(timeout()), this, SLOT(stop()));
@@ -42,6 +42,7 @@ TaskId TaskQueue::addTask(TaskPtr task) {
 	{
 		QMutexLocker lock(&_tasksToProcessMutex);
 		_tasksToProcess.push_back(task);
+		STATS_ADD("task_queue_depth", _tasksToProcess.size());
 	}
 
 	wakeThread();
@@ -59,16 +60,24 @@ void TaskQueue::addTasks(const TasksList &tasks) {
 }
 
 void TaskQueue::wakeThread() {
-	if (!_thread) {
-		_thread = new QThread();
+	int32 threadsNeeded = 1;
+	if (_threadsCount > 1) {
+		QMutexLocker lock(&_tasksToProcessMutex);
+		threadsNeeded = qMin(_threadsCount, _tasksToProcess.size() - _tasksProcessed.size());
+	}
+	while (_threads.size() < threadsNeeded) {
+		QThread *thread = new QThread();
 
-		_worker = new TaskQueueWorker(this);
-		_worker->moveToThread(_thread);
+		TaskQueueWorker *worker = new TaskQueueWorker(this);
+		worker->moveToThread(thread);
 
-		connect(this, SIGNAL(taskAdded()), _worker, SLOT(onTaskAdded()));
-		connect(_worker, SIGNAL(taskProcessed()), this, SLOT(onTaskProcessed()));
+		connect(this, SIGNAL(taskAdded()), worker, SLOT(onTaskAdded()));
+		connect(worker, SIGNAL(taskProcessed()), this, SLOT(onTaskProcessed()));
 
-		_thread->start();
+		thread->start();
+
+		_threads.push_back(thread);
+		_workers.push_back(worker);
 	}
 	if (_stopTimer) _stopTimer->stop();
 	emit taskAdded();
@@ -80,6 +89,7 @@ void TaskQueue::cancelTask(TaskId id) {
 		for (int32 i = 0, l = _tasksToProcess.size(); i != l; ++i) {
 			if (_tasksToProcess.at(i)->id() == id) {
 				_tasksToProcess.removeAt(i);
+				_tasksProcessed.remove(id);
 				return;
 			}
 		}
@@ -114,18 +124,24 @@ void TaskQueue::onTaskProcessed() {
 }
 
 void TaskQueue::stop() {
-	if (_thread) {
-		_thread->requestInterruption();
-		_thread->quit();
+	if (!_threads.isEmpty()) {
+		for (int32 i = 0, l = _threads.size(); i != l; ++i) {
+			_threads.at(i)->requestInterruption();
+			_threads.at(i)->quit();
+		}
 		DEBUG_LOG(("Waiting for taskThread to finish"));
-		_thread->wait();
-		delete _worker;
-		delete _thread;
-		_worker = 0;
-		_thread = 0;
+		for (int32 i = 0, l = _threads.size(); i != l; ++i) {
+			_threads.at(i)->wait();
+			delete _workers.at(i);
+			delete _threads.at(i);
+		}
+		_workers.clear();
+		_threads.clear();
 	}
 	_tasksToProcess.clear();
 	_tasksToFinish.clear();
+	_tasksInProcess.clear();
+	_tasksProcessed.clear();
 }
 
 TaskQueue::~TaskQueue() {
@@ -142,24 +158,36 @@ void TaskQueueWorker::onTaskAdded() {
 		TaskPtr task;
 		{
 			QMutexLocker lock(&_queue->_tasksToProcessMutex);
-			if (!_queue->_tasksToProcess.isEmpty()) {
-				task = _queue->_tasksToProcess.front();
-			}
+			task = takeTaskToProcess();
 		}
 
+		someTasksLeft = false;
 		if (task) {
-			task->process();
+			{
+				STATS_TIMER("task_process_ms");
+				task->process();
+			}
 			bool emitTaskProcessed = false;
 			{
 				QMutexLocker lockToProcess(&_queue->_tasksToProcessMutex);
-				if (!_queue->_tasksToProcess.isEmpty() && _queue->_tasksToProcess.front() == task) {
+				_queue->_tasksInProcess.remove(task->id());
+				if (_queue->_tasksToProcess.contains(task)) {
+					_queue->_tasksProcessed.insert(task->id());
+				}
+
+				// move all the processed tasks from the queue front to the finish queue
+				while (!_queue->_tasksToProcess.isEmpty() && _queue->_tasksProcessed.contains(_queue->_tasksToProcess.front()->id())) {
+					TaskPtr processed = _queue->_tasksToProcess.front();
 					_queue->_tasksToProcess.pop_front();
-					someTasksLeft = !_queue->_tasksToProcess.isEmpty();
+					_queue->_tasksProcessed.remove(processed->id());
 
 					QMutexLocker lockToFinish(&_queue->_tasksToFinishMutex);
-					emitTaskProcessed = _queue->_tasksToFinish.isEmpty();
-					_queue->_tasksToFinish.push_back(task);
+					if (_queue->_tasksToFinish.isEmpty()) {
+						emitTaskProcessed = true;
+					}
+					_queue->_tasksToFinish.push_back(processed);
 				}
+				someTasksLeft = (_queue->_tasksToProcess.size() > _queue->_tasksInProcess.size() + _queue->_tasksProcessed.size());
 			}
 			if (emitTaskProcessed) {
 				emit taskProcessed();
@@ -171,6 +199,17 @@ void TaskQueueWorker::onTaskAdded() {
 	_inTaskAdded = false;
 }
 
+TaskPtr TaskQueueWorker::takeTaskToProcess() {
+	for (TasksList::const_iterator i = _queue->_tasksToProcess.cbegin(), e = _queue->_tasksToProcess.cend(); i != e; ++i) {
+		TaskId id = (*i)->id();
+		if (!_queue->_tasksInProcess.contains(id) && !_queue->_tasksProcessed.contains(id)) {
+			_queue->_tasksInProcess.insert(id);
+			return *i;
+		}
+	}
+	return TaskPtr();
+}
+
 FileLoadTask::FileLoadTask(const QString &filepath, PrepareMediaType type, const FileLoadTo &to, FileLoadForceConfirmType confirm) : _id(MTP::nonce<uint64>())
 , _to(to)
 , _filepath(filepath)
@@ -368,15 +407,20 @@ void FileLoadTask::process() {
 			if (animated) {
 				attributes.push_back(MTP_documentAttributeAnimated());
 			} else if (_type != PrepareDocument) {
-				QPixmap thumb = (w > 100 || h > 100) ? QPixmap::fromImage(fullimage.scaled(100, 100, Qt::KeepAspectRatio, Qt::SmoothTransformation), Qt::ColorOnly) : QPixmap::fromImage(fullimage);
+				// each smaller size is scaled from the previous one, not from the full image
+				QImage fullScaled = (w > 1280 || h > 1280) ? fullimage.scaled(1280, 1280, Qt::KeepAspectRatio, Qt::SmoothTransformation) : fullimage;
+				QImage mediumScaled = (w > 320 || h > 320) ? fullScaled.scaled(320, 320, Qt::KeepAspectRatio, Qt::SmoothTransformation) : fullScaled;
+				QImage thumbScaled = (w > 100 || h > 100) ? mediumScaled.scaled(100, 100, Qt::KeepAspectRatio, Qt::SmoothTransformation) : mediumScaled;
+
+				QPixmap thumb = (w > 100 || h > 100) ? QPixmap::fromImage(thumbScaled, Qt::ColorOnly) : QPixmap::fromImage(fullimage);
 				photoThumbs.insert('s', thumb);
 				photoSizes.push_back(MTP_photoSize(MTP_string("s"), MTP_fileLocationUnavailable(MTP_long(0), MTP_int(0), MTP_long(0)), MTP_int(thumb.width()), MTP_int(thumb.height()), MTP_int(0)));
 
-				QPixmap medium = (w > 320 || h > 320) ? QPixmap::fromImage(fullimage.scaled(320, 320, Qt::KeepAspectRatio, Qt::SmoothTransformation), Qt::ColorOnly) : QPixmap::fromImage(fullimage);
+				QPixmap medium = (w > 320 || h > 320) ? QPixmap::fromImage(mediumScaled, Qt::ColorOnly) : QPixmap::fromImage(fullimage);
 				photoThumbs.insert('m', medium);
 				photoSizes.push_back(MTP_photoSize(MTP_string("m"), MTP_fileLocationUnavailable(MTP_long(0), MTP_int(0), MTP_long(0)), MTP_int(medium.width()), MTP_int(medium.height()), MTP_int(0)));
 
-				QPixmap full = (w > 1280 || h > 1280) ? QPixmap::fromImage(fullimage.scaled(1280, 1280, Qt::KeepAspectRatio, Qt::SmoothTransformation), Qt::ColorOnly) : QPixmap::fromImage(fullimage);
+				QPixmap full = (w > 1280 || h > 1280) ? QPixmap::fromImage(fullScaled, Qt::ColorOnly) : QPixmap::fromImage(fullimage);
 				photoThumbs.insert('y', full);
 				photoSizes.push_back(MTP_photoSize(MTP_string("y"), MTP_fileLocationUnavailable(MTP_long(0), MTP_int(0), MTP_long(0)), MTP_int(full.width()), MTP_int(full.height()), MTP_int(0)));
 
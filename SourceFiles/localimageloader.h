@@ -108,7 +108,7 @@ class TaskQueue : public QObject {
 
 public:
 
-	TaskQueue(QObject *parent, int32 stopTimeoutMs = 0); // <= 0 - never stop worker
+	TaskQueue(QObject *parent, int32 stopTimeoutMs = 0, int32 threadsCount = 1); // <= 0 - never stop worker
 
 	TaskId addTask(TaskPtr task);
 	void addTasks(const TasksList &tasks);
@@ -137,8 +137,14 @@ private:
 
 	TasksList _tasksToProcess, _tasksToFinish;
 	QMutex _tasksToProcessMutex, _tasksToFinishMutex;
-	QThread *_thread;
-	TaskQueueWorker *_worker;
+
+	// tasks are processed in parallel, but finished in the order they were added
+	typedef QSet<TaskId> TaskIds;
+	TaskIds _tasksInProcess, _tasksProcessed;
+
+	int32 _threadsCount;
+	QList<QThread*> _threads;
+	QList<TaskQueueWorker*> _workers;
 	QTimer *_stopTimer;
 
 };
@@ -160,6 +166,8 @@ public slots:
 	void onTaskAdded();
 
 private:
+	TaskPtr takeTaskToProcess(); // under _queue->_tasksToProcessMutex
+
 	TaskQueue *_queue;
 	bool _inTaskAdded;
 
@@ -554,6 +554,7 @@ namespace {
 		lskReportSpamStatuses    = 0x0d, // no data
 		lskSavedGifsOld          = 0x0e, // no data
 		lskSavedGifs             = 0x0f, // no data
+		lskVoiceWaveforms        = 0x10, // no data
 	};
 
 	enum {
@@ -609,6 +610,7 @@ namespace {
 		dbiAutoPlay = 0x37,
 		dbiAdaptiveForWide = 0x38,
 		dbiHiddenPinnedMessages = 0x39,
+		dbiConnectStats = 0x3a,
 
 		dbiEncryptedWithSalt = 333,
 		dbiEncrypted = 444,
@@ -649,6 +651,10 @@ namespace {
 
 	FileKey _savedPeersKey = 0;
 
+	FileKey _voiceWaveformsKey = 0;
+	typedef QMap<uint64, QByteArray> VoiceWaveforms; // document id -> 5 bit encoded counted waveform
+	VoiceWaveforms _voiceWaveforms;
+
 	typedef QMap<StorageKey, FileDesc> StorageMap;
 	StorageMap _imagesMap, _stickerImagesMap, _audiosMap;
 	int32 _storageImagesSize = 0, _storageStickersSize = 0, _storageAudiosSize = 0;
@@ -746,6 +752,67 @@ namespace {
 		}
 	}
 
+	void _writeVoiceWaveforms(WriteMapWhen when = WriteMapSoon) {
+		if (when != WriteMapNow) {
+			_manager->writeVoiceWaveforms(when == WriteMapFast);
+			return;
+		}
+		if (!_working()) return;
+
+		_manager->writingVoiceWaveforms();
+		if (_voiceWaveforms.isEmpty()) {
+			if (_voiceWaveformsKey) {
+				clearKey(_voiceWaveformsKey);
+				_voiceWaveformsKey = 0;
+				_mapChanged = true;
+				_writeMap();
+			}
+		} else {
+			if (!_voiceWaveformsKey) {
+				_voiceWaveformsKey = genKey();
+				_mapChanged = true;
+				_writeMap(WriteMapFast);
+			}
+			quint32 size = sizeof(quint32);
+			for (VoiceWaveforms::const_iterator i = _voiceWaveforms.cbegin(), e = _voiceWaveforms.cend(); i != e; ++i) {
+				// id + waveform
+				size += sizeof(quint64) + _bytearraySize(i.value());
+			}
+
+			EncryptedDescriptor data(size);
+			data.stream << quint32(_voiceWaveforms.size());
+			for (VoiceWaveforms::const_iterator i = _voiceWaveforms.cbegin(), e = _voiceWaveforms.cend(); i != e; ++i) {
+				data.stream << quint64(i.key()) << i.value();
+			}
+
+			FileWriteDescriptor file(_voiceWaveformsKey);
+			file.writeEncrypted(data);
+		}
+	}
+
+	void _readVoiceWaveforms() {
+		FileReadDescriptor waveforms;
+		if (!readEncryptedFile(waveforms, _voiceWaveformsKey)) {
+			clearKey(_voiceWaveformsKey);
+			_voiceWaveformsKey = 0;
+			_writeMap();
+			return;
+		}
+
+		quint32 count = 0;
+		waveforms.stream >> count;
+		for (quint32 i = 0; i < count; ++i) {
+			quint64 id;
+			QByteArray waveform;
+			waveforms.stream >> id >> waveform;
+			if (!_checkStreamStatus(waveforms.stream)) {
+				_voiceWaveforms.clear();
+				return;
+			}
+			_voiceWaveforms.insert(id, waveform);
+		}
+	}
+
 	void _readLocations() {
 		FileReadDescriptor locations;
 		if (!readEncryptedFile(locations, _locationsKey)) {
@@ -919,6 +986,24 @@ namespace {
 			MTP::configure(dcId, uid);
 		} break;
 
+		case dbiConnectStats: {
+			quint32 count;
+			stream >> count;
+			if (!_checkStreamStatus(stream)) return false;
+
+			mtpConnectStats stats;
+			for (quint32 i = 0; i < count; ++i) {
+				qint32 key, ms, failed;
+				stream >> key >> ms >> failed;
+				if (!_checkStreamStatus(stream)) return false;
+
+				mtpConnectStat &stat(stats[key]);
+				stat.ms = ms;
+				stat.failed = failed;
+			}
+			MTP::setConnectStats(stats);
+		} break;
+
 		case dbiKey: {
 			qint32 dcId;
 			quint32 key[64];
@@ -1665,9 +1750,13 @@ namespace {
 		}
 
 		mtpKeysMap keys = MTP::getKeys();
+		mtpConnectStats stats = MTP::getConnectStats();
 
 		quint32 size = sizeof(quint32) + sizeof(qint32) + sizeof(quint32);
 		size += keys.size() * (sizeof(quint32) + sizeof(quint32) + 256);
+		if (!stats.isEmpty()) {
+			size += sizeof(quint32) + sizeof(quint32) + stats.size() * 3 * sizeof(qint32);
+		}
 
 		EncryptedDescriptor data(size);
 		data.stream << quint32(dbiUser) << qint32(MTP::authedId()) << quint32(MTP::maindc());
@@ -1675,6 +1764,12 @@ namespace {
 			data.stream << quint32(dbiKey) << quint32((*i)->getDC());
 			(*i)->write(data.stream);
 		}
+		if (!stats.isEmpty()) {
+			data.stream << quint32(dbiConnectStats) << quint32(stats.size());
+			for (mtpConnectStats::const_iterator i = stats.cbegin(), e = stats.cend(); i != e; ++i) {
+				data.stream << qint32(i.key()) << qint32(i->ms) << qint32(i->failed);
+			}
+		}
 
 		mtp.writeEncrypted(data, _localKey);
 	}
@@ -1757,6 +1852,7 @@ namespace {
 		quint64 locationsKey = 0, reportSpamStatusesKey = 0;
 		quint64 recentStickersKeyOld = 0, stickersKey = 0, savedGifsKey = 0;
 		quint64 backgroundKey = 0, userSettingsKey = 0, recentHashtagsAndBotsKey = 0, savedPeersKey = 0;
+		quint64 voiceWaveformsKey = 0;
 		while (!map.stream.atEnd()) {
 			quint32 keyType;
 			map.stream >> keyType;
@@ -1849,6 +1945,9 @@ namespace {
 			case lskSavedPeers: {
 				map.stream >> savedPeersKey;
 			} break;
+			case lskVoiceWaveforms: {
+				map.stream >> voiceWaveformsKey;
+			} break;
 			default:
 				LOG(("App Error: unknown key type in encrypted map: %1").arg(keyType));
 				return Local::ReadMapFailed;
@@ -1878,6 +1977,7 @@ namespace {
 		_backgroundKey = backgroundKey;
 		_userSettingsKey = userSettingsKey;
 		_recentHashtagsAndBotsKey = recentHashtagsAndBotsKey;
+		_voiceWaveformsKey = voiceWaveformsKey;
 		_oldMapVersion = mapData.version;
 		if (_oldMapVersion < AppVersion) {
 			_mapChanged = true;
@@ -1892,6 +1992,9 @@ namespace {
 		if (_reportSpamStatusesKey) {
 			_readReportSpamStatuses();
 		}
+		if (_voiceWaveformsKey) {
+			_readVoiceWaveforms();
+		}
 
 		_readUserSettings();
 		_readMtpData();
@@ -1951,6 +2054,7 @@ namespace {
 		if (_backgroundKey) mapSize += sizeof(quint32) + sizeof(quint64);
 		if (_userSettingsKey) mapSize += sizeof(quint32) + sizeof(quint64);
 		if (_recentHashtagsAndBotsKey) mapSize += sizeof(quint32) + sizeof(quint64);
+		if (_voiceWaveformsKey) mapSize += sizeof(quint32) + sizeof(quint64);
 		EncryptedDescriptor mapData(mapSize);
 		if (!_draftsMap.isEmpty()) {
 			mapData.stream << quint32(lskDraft) << quint32(_draftsMap.size());
@@ -2009,6 +2113,9 @@ namespace {
 		if (_recentHashtagsAndBotsKey) {
 			mapData.stream << quint32(lskRecentHashtagsAndBots) << quint64(_recentHashtagsAndBotsKey);
 		}
+		if (_voiceWaveformsKey) {
+			mapData.stream << quint32(lskVoiceWaveforms) << quint64(_voiceWaveformsKey);
+		}
 		map.writeEncrypted(mapData);
 
 		_mapChanged = false;
@@ -2023,6 +2130,8 @@ namespace _local_inner {
 		connect(&_mapWriteTimer, SIGNAL(timeout()), this, SLOT(mapWriteTimeout()));
 		_locationsWriteTimer.setSingleShot(true);
 		connect(&_locationsWriteTimer, SIGNAL(timeout()), this, SLOT(locationsWriteTimeout()));
+		_voiceWaveformsWriteTimer.setSingleShot(true);
+		connect(&_voiceWaveformsWriteTimer, SIGNAL(timeout()), this, SLOT(voiceWaveformsWriteTimeout()));
 	}
 
 	void Manager::writeMap(bool fast) {
@@ -2049,6 +2158,18 @@ namespace _local_inner {
 		_locationsWriteTimer.stop();
 	}
 
+	void Manager::writeVoiceWaveforms(bool fast) {
+		if (!_voiceWaveformsWriteTimer.isActive() || fast) {
+			_voiceWaveformsWriteTimer.start(fast ? 1 : WriteMapTimeout);
+		} else if (_voiceWaveformsWriteTimer.remainingTime() <= 0) {
+			voiceWaveformsWriteTimeout();
+		}
+	}
+
+	void Manager::writingVoiceWaveforms() {
+		_voiceWaveformsWriteTimer.stop();
+	}
+
 	void Manager::mapWriteTimeout() {
 		_writeMap(WriteMapNow);
 	}
@@ -2057,6 +2178,10 @@ namespace _local_inner {
 		_writeLocations(WriteMapNow);
 	}
 
+	void Manager::voiceWaveformsWriteTimeout() {
+		_writeVoiceWaveforms(WriteMapNow);
+	}
+
 	void Manager::finish() {
 		if (_mapWriteTimer.isActive()) {
 			mapWriteTimeout();
@@ -2064,6 +2189,9 @@ namespace _local_inner {
 		if (_locationsWriteTimer.isActive()) {
 			locationsWriteTimeout();
 		}
+		if (_voiceWaveformsWriteTimer.isActive()) {
+			voiceWaveformsWriteTimeout();
+		}
 	}
 
 }
@@ -2072,6 +2200,9 @@ namespace Local {
 
 	void finish() {
 		if (_manager) {
+			if (_localKey.created() && MTP::authedId()) {
+				_writeMtpData(); // save connect stats
+			}
 			_writeMap(WriteMapNow);
 			_manager->finish();
 			_manager->deleteLater();
@@ -2272,6 +2403,8 @@ namespace Local {
 		_locationsKey = _reportSpamStatusesKey = 0;
 		_recentStickersKeyOld = _stickersKey = _savedGifsKey = 0;
 		_backgroundKey = _userSettingsKey = _recentHashtagsAndBotsKey = _savedPeersKey = 0;
+		_voiceWaveformsKey = 0;
+		_voiceWaveforms.clear();
 		_oldMapVersion = _oldSettingsVersion = 0;
 		_mapChanged = true;
 		_writeMap(WriteMapNow);
@@ -2951,6 +3084,9 @@ namespace Local {
 				if (!_waveform.isEmpty()) {
 					voice->waveform = _waveform;
 					voice->wavemax = _wavemax;
+
+					_voiceWaveforms.insert(_doc->id, documentWaveformEncode5bit(_waveform));
+					_writeVoiceWaveforms();
 				}
 				if (voice->waveform.isEmpty()) {
 					voice->waveform.resize(1);
@@ -2986,6 +3122,16 @@ namespace Local {
 
 	void countVoiceWaveform(DocumentData *document) {
 		if (VoiceData *voice = document->voice()) {
+			VoiceWaveforms::const_iterator i = _voiceWaveforms.constFind(document->id);
+			if (i != _voiceWaveforms.cend()) { // was counted already
+				voice->waveform = documentWaveformDecode(i.value());
+				voice->wavemax = 0;
+				for (int32 j = 0, l = voice->waveform.size(); j < l; ++j) {
+					uchar waveat = voice->waveform.at(j);
+					if (uchar(voice->wavemax) < waveat) voice->wavemax = waveat;
+				}
+				if (!voice->waveform.isEmpty()) return;
+			}
 			if (_localLoader) {
 				voice->waveform.resize(1 + sizeof(TaskId));
 				voice->waveform[0] = -1; // counting
@@ -3953,6 +4099,11 @@ namespace Local {
 				_savedPeersKey = 0;
 				_mapChanged = true;
 			}
+			if (_voiceWaveformsKey) {
+				_voiceWaveformsKey = 0;
+				_voiceWaveforms.clear();
+				_mapChanged = true;
+			}
 			_writeMap();
 		} else {
 			if (task & ClearManagerStorage) {
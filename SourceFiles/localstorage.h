@@ -35,17 +35,21 @@ namespace _local_inner {
 		void writingMap();
 		void writeLocations(bool fast);
 		void writingLocations();
+		void writeVoiceWaveforms(bool fast);
+		void writingVoiceWaveforms();
 		void finish();
 
 	public slots:
 
 		void mapWriteTimeout();
 		void locationsWriteTimeout();
+		void voiceWaveformsWriteTimeout();
 
 	private:
 
 		QTimer _mapWriteTimer;
 		QTimer _locationsWriteTimer;
+		QTimer _voiceWaveformsWriteTimer;
 
 	};
 
@@ -88,10 +88,21 @@ QString _logsEntryStart() {
 class LogsDataFields {
 public:
 
-	LogsDataFields() {
+	LogsDataFields() : writer(this) {
 		for (int32 i = 0; i < LogDataCount; ++i) {
 			files[i].reset(new QFile());
 		}
+		writer.start();
+	}
+
+	~LogsDataFields() {
+		{
+			QMutexLocker lock(&pendingMutex);
+			stopping = true;
+			pendingCondition.wakeOne();
+		}
+		writer.wait();
+		writePending(false);
 	}
 
 	bool openMain() {
@@ -123,14 +134,24 @@ public:
 	}
 
 	void write(LogDataType type, const QString &msg) {
+		if (type != LogDataMain) { // debug logs are written in batches by the writer thread
+			QMutexLocker lock(&pendingMutex);
+			pending.push_back(qMakePair(type, msg));
+			pendingCondition.wakeOne();
+			return;
+		}
+
 		QMutexLocker lock(_logsMutex(type));
-		if (type != LogDataMain) reopenDebug();
 		if (!streams[type].device()) return;
 
 		streams[type] << msg;
 		streams[type].flush();
 	}
 
+	void flushPending() { // called from the crash handler, must not block
+		writePending(true);
+	}
+
 private:
 
 	QSharedPointer<QFile> files[LogDataCount];
@@ -138,6 +159,74 @@ private:
 
 	int32 part = -1;
 
+	class Writer : public QThread {
+	public:
+		Writer(LogsDataFields *fields) : _fields(fields) {
+		}
+
+	protected:
+		void run() {
+			_fields->writerLoop();
+		}
+
+	private:
+		LogsDataFields *_fields;
+
+	};
+	Writer writer;
+
+	typedef QList<QPair<LogDataType, QString> > PendingList;
+	PendingList pending;
+	QMutex pendingMutex;
+	QWaitCondition pendingCondition;
+	bool stopping = false;
+
+	void writerLoop() {
+		QMutexLocker lock(&pendingMutex);
+		while (!stopping) {
+			if (pending.isEmpty()) {
+				pendingCondition.wait(&pendingMutex);
+				continue;
+			}
+			lock.unlock();
+			writePending(false);
+			lock.relock();
+		}
+	}
+
+	void writePending(bool tryOnly) {
+		QMutex *streamsMutex = _logsMutex(LogDataDebug); // guards all the debug streams
+		if (tryOnly) {
+			if (!streamsMutex->tryLock()) return;
+			if (!pendingMutex.tryLock()) {
+				streamsMutex->unlock();
+				return;
+			}
+		} else {
+			streamsMutex->lock();
+			pendingMutex.lock();
+		}
+		PendingList list;
+		qSwap(list, pending);
+		pendingMutex.unlock();
+
+		if (!list.isEmpty()) {
+			reopenDebug();
+
+			bool written[LogDataCount] = { false };
+			for (PendingList::const_iterator i = list.cbegin(), e = list.cend(); i != e; ++i) {
+				if (streams[i->first].device()) {
+					streams[i->first] << i->second;
+					written[i->first] = true;
+				}
+			}
+			for (int32 i = 0; i < LogDataCount; ++i) {
+				if (written[i]) streams[i].flush();
+			}
+		}
+		streamsMutex->unlock();
+	}
+
 	bool reopen(LogDataType type, int32 dayIndex, const QString &postfix) {
 		if (streams[type].device()) {
 			if (type == LogDataMain) {
@@ -604,6 +693,64 @@ void _moveOldDataFiles(const QString &wasDir) {
 
 #endif
 
+namespace Stats {
+
+	struct Value {
+		Value() : count(0), sum(0), max(0) {
+		}
+		int64 count, sum, max;
+	};
+	typedef QHash<const char*, Value> Values;
+	Values StatsValues;
+	QMutex StatsMutex;
+
+	void add(const char *name, int64 value) {
+		QMutexLocker lock(&StatsMutex);
+		Value &v(StatsValues[name]);
+		++v.count;
+		v.sum += value;
+		if (v.max < value) v.max = value;
+	}
+
+	Timer::Timer(const char *name) : _name(cDebug() ? name : 0), _started(_name ? getms(true) : 0) {
+	}
+
+	Timer::~Timer() {
+		if (_name) add(_name, int64(getms(true) - _started));
+	}
+
+	QString json() {
+		QMap<QString, Value> sorted; // same literals from different files can have different addresses
+		{
+			QMutexLocker lock(&StatsMutex);
+			for (Values::const_iterator i = StatsValues.cbegin(), e = StatsValues.cend(); i != e; ++i) {
+				Value &v(sorted[QString::fromLatin1(i.key())]);
+				v.count += i.value().count;
+				v.sum += i.value().sum;
+				if (v.max < i.value().max) v.max = i.value().max;
+			}
+		}
+
+		QStringList result;
+		for (QMap<QString, Value>::const_iterator i = sorted.cbegin(), e = sorted.cend(); i != e; ++i) {
+			result.push_back(qsl("\"%1\": {\"count\": %2, \"sum\": %3, \"max\": %4}").arg(i.key()).arg(i.value().count).arg(i.value().sum).arg(i.value().max));
+		}
+		return qsl("{\n\t") + result.join(qsl(",\n\t")) + qsl("\n}\n");
+	}
+
+	QString dump() {
+		QDir().mkpath(cWorkingDir() + qstr("DebugLogs"));
+
+		QFile f(cWorkingDir() + qstr("DebugLogs/stats.json"));
+		if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+			return QString();
+		}
+		f.write(json().toUtf8());
+		return f.fileName();
+	}
+
+}
+
 namespace SignalHandlers {
 
 	QString CrashDumpPath;
@@ -736,6 +883,10 @@ namespace SignalHandlers {
 		QMutexLocker lock(&LoggingCrashMutex);
 		LoggingCrashThreadId = thread;
 
+		if (LogsData) {
+			LogsData->flushPending();
+		}
+
 		if (!LoggingCrashHeaderWritten) {
 			LoggingCrashHeaderWritten = true;
 			const AnnotationsMap c_ProcessAnnotations(ProcessAnnotations);
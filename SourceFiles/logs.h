@@ -86,6 +86,34 @@ namespace Logs {
 #define MTP_LOG(dc, msg) { if (cDebug() || !Logs::started()) Logs::writeMtp(dc, QString msg); }
 //usage MTP_LOG(dc, ("log: %1 %2").arg(1).arg(2))
 
+namespace Stats { // collected only in debug mode, name must be a string literal
+
+	void add(const char *name, int64 value);
+
+	class Timer {
+	public:
+		Timer(const char *name);
+		~Timer();
+
+	private:
+		const char *_name;
+		uint64 _started;
+
+	};
+
+	QString json(); // {"name": {"count": 1, "sum": 2, "max": 2}, ...}
+	QString dump(); // writes json() to DebugLogs/stats.json, returns the file path or empty string on fail
+
+}
+
+#define STATS_ADD(name, value) { if (cDebug()) Stats::add(name, value); }
+//usage STATS_ADD("mtp_received_bytes", size)
+
+#define STATS_TIMER_JOIN(a, b) a##b
+#define STATS_TIMER_NAME(line) STATS_TIMER_JOIN(_statsTimer, line)
+#define STATS_TIMER(name) Stats::Timer STATS_TIMER_NAME(__LINE__)(name)
+//usage STATS_TIMER("history_paint_ms"), adds ms from here till the end of the scope
+
 namespace SignalHandlers {
 
 	struct dump {
@@ -792,6 +792,11 @@ void MainWidget::ui_repaintHistoryItem(const HistoryItem *item) {
 	if (overview) overview->ui_repaintHistoryItem(item);
 }
 
+void MainWidget::ui_repaintHistoryItem(const HistoryItem *item, const QRect &rect) {
+	history.ui_repaintHistoryItem(item, rect);
+	if (overview) overview->ui_repaintHistoryItem(item);
+}
+
 void MainWidget::ui_repaintInlineItem(const LayoutInlineItem *layout) {
 	history.ui_repaintInlineItem(layout);
 }
@@ -3466,6 +3471,11 @@ void MainWidget::start(const MTPUser &user) {
 	Local::readStickers();
 	Local::readSavedGifs();
 	history.start();
+
+	QList<int32> keyDcs = MTP::prepareDownloadKeys();
+	for (int32 i = 0, l = keyDcs.size(); i < l; ++i) {
+		App::app()->killDownloadSessionsStart(keyDcs.at(i)); // stop the sessions if no download uses them
+	}
 }
 
 bool MainWidget::started() {
@@ -430,6 +430,7 @@ public:
 	bool isItemVisible(HistoryItem *item);
 
 	void ui_repaintHistoryItem(const HistoryItem *item);
+	void ui_repaintHistoryItem(const HistoryItem *item, const QRect &rect);
 	void ui_repaintInlineItem(const LayoutInlineItem *layout);
 	bool ui_isInlineItemVisible(const LayoutInlineItem *layout);
 	bool ui_isInlineItemBeingChosen();
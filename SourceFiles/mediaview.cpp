@@ -81,6 +81,7 @@ MediaView::MediaView() : TWidget(App::wnd())
 , _zoomToScreen(0)
 , _pressed(false)
 , _dragging(0)
+, _currentScaledKey(0)
 , _gif(0)
 , _full(-1)
 , _docNameWidth(0)
@@ -198,22 +199,7 @@ void MediaView::moveToScreen() {
 void MediaView::mediaOverviewUpdated(PeerData *peer, MediaOverviewType type) {
 	if (!_photo && !_doc) return;
 	if (_history && (_history->peer == peer || (_migrated && _migrated->peer == peer)) && type == _overview) {
-		_index = -1;
-		if (_msgmigrated) {
-			for (int i = 0, l = _migrated->overview[_overview].size(); i < l; ++i) {
-				if (_migrated->overview[_overview].at(i) == _msgid) {
-					_index = i;
-					break;
-				}
-			}
-		} else {
-			for (int i = 0, l = _history->overview[_overview].size(); i < l; ++i) {
-				if (_history->overview[_overview].at(i) == _msgid) {
-					_index = i;
-					break;
-				}
-			}
-		}
+		_index = (_msgmigrated ? _migrated : _history)->overviewIndexOf(_overview, _msgid);
 		updateControls();
 		preloadData(0);
 	} else if (_user == peer && type == OverviewCount) {
@@ -1137,10 +1123,22 @@ void MediaView::paintEvent(QPaintEvent *e) {
 			if (!_gif && (!_doc || !_doc->sticker() || _doc->sticker()->img->isNull()) && toDraw.hasAlpha()) {
 				p.fillRect(imgRect, _transparentBrush);
 			}
-			if (toDraw.width() != _w * cIntRetinaFactor()) {
+			int32 rf(cIntRetinaFactor());
+			if (!_gif && toDraw.width() > _w * rf) { // zoomed out - scale once, not on every paint
+				if (_currentScaledKey != toDraw.cacheKey() || _currentScaled.width() != _w * rf || _currentScaled.height() != _h * rf) {
+					_currentScaled = QPixmap::fromImage(toDraw.toImage().scaled(_w * rf, _h * rf, Qt::IgnoreAspectRatio, Qt::SmoothTransformation), Qt::ColorOnly);
+					_currentScaled.setDevicePixelRatio(cRetinaFactor());
+					_currentScaledKey = toDraw.cacheKey();
+				}
+				p.drawPixmap(_x, _y, _currentScaled);
+			} else if (toDraw.width() != _w * rf) { // zoomed in - scale only the visible part
+				QRect visible(imgRect.intersected(r));
+				float64 scalex = float64(toDraw.width()) / _w, scaley = float64(toDraw.height()) / _h;
+				QRectF from((visible.x() - _x) * scalex, (visible.y() - _y) * scaley, visible.width() * scalex, visible.height() * scaley);
+
 				bool was = (p.renderHints() & QPainter::SmoothPixmapTransform);
 				if (!was) p.setRenderHint(QPainter::SmoothPixmapTransform, true);
-				p.drawPixmap(QRect(_x, _y, _w, _h), toDraw);
+				p.drawPixmap(QRectF(visible), toDraw, from);
 				if (!was) p.setRenderHint(QPainter::SmoothPixmapTransform, false);
 			} else {
 				p.drawPixmap(_x, _y, toDraw);
@@ -1969,6 +1967,8 @@ void MediaView::hide() {
 	a_cOpacity = anim::fvalue(1, 1);
 	QWidget::hide();
 	stopGif();
+	_currentScaled = QPixmap();
+	_currentScaledKey = 0;
 
 	Notify::clipStopperHidden(ClipStopperMediaview);
 }
@@ -2013,12 +2013,8 @@ void MediaView::updateImage() {
 
 void MediaView::findCurrent() {
 	if (_msgmigrated) {
-		for (int i = 0, l = _migrated->overview[_overview].size(); i < l; ++i) {
-			if (_migrated->overview[_overview].at(i) == _msgid) {
-				_index = i;
-				break;
-			}
-		}
+		int32 index = _migrated->overviewIndexOf(_overview, _msgid);
+		if (index >= 0) _index = index;
 		if (!_history->overviewCountLoaded(_overview)) {
 			loadBack();
 		} else if (_history->overviewLoaded(_overview) && !_migrated->overviewLoaded(_overview)) { // all loaded
@@ -2027,12 +2023,8 @@ void MediaView::findCurrent() {
 			}
 		}
 	} else {
-		for (int i = 0, l = _history->overview[_overview].size(); i < l; ++i) {
-			if (_history->overview[_overview].at(i) == _msgid) {
-				_index = i;
-				break;
-			}
-		}
+		int32 index = _history->overviewIndexOf(_overview, _msgid);
+		if (index >= 0) _index = index;
 		if (!_history->overviewLoaded(_overview)) {
 			if (!_history->overviewCountLoaded(_overview) || (_index < 2 && _history->overviewCount(_overview) > 0) || (_index < 1 && _migrated && !_migrated->overviewLoaded(_overview))) {
 				loadBack();
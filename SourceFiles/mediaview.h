@@ -142,6 +142,8 @@ private:
 	bool _pressed;
 	int32 _dragging;
 	QPixmap _current;
+	QPixmap _currentScaled; // _current smooth scaled to the zoomed out size, rebuilt on zoom change
+	qint64 _currentScaledKey;
 	ClipReader *_gif;
 	int32 _full; // -1 - thumb, 0 - medium, 1 - full
 
@@ -757,6 +757,32 @@ namespace MTP {
 		}
 	}
 
+	QList<int32> prepareDownloadKeys() {
+		QList<int32> result;
+		if (!_started) return result;
+
+		QSet<int32> withKeys;
+		mtpKeysMap keys(mtpGetKeys());
+		for (mtpKeysMap::const_iterator i = keys.cbegin(), e = keys.cend(); i != e; ++i) {
+			withKeys.insert((*i)->getDC());
+		}
+		{
+			QReadLocker lock(mtpDcOptionsMutex());
+			const mtpDcOptions &options(cDcOptions());
+			for (mtpDcOptions::const_iterator i = options.cbegin(), e = options.cend(); i != e; ++i) {
+				int32 dc = i.value().id;
+				if (dc != maindc() && !withKeys.contains(dc) && !result.contains(dc)) {
+					result.push_back(dc);
+				}
+			}
+		}
+		for (int32 i = 0, l = result.size(); i < l; ++i) { // each session creates its key in its own connection thread
+			DEBUG_LOG(("MTP Info: preparing auth key for dc %1").arg(result.at(i)));
+			_mtp_internal::getSession(MTP::dld(0) + result.at(i));
+		}
+		return result;
+	}
+
 	void cancel(mtpRequestId requestId) {
 		if (!_started) return;
 
@@ -904,6 +930,14 @@ namespace MTP {
 		return mtpSetKey(dc, key);
 	}
 
+	mtpConnectStats getConnectStats() {
+		return mtpGetConnectStats();
+	}
+
+	void setConnectStats(const mtpConnectStats &stats) {
+		return mtpSetConnectStats(stats);
+	}
+
 	QReadWriteLock *dcOptionsMutex() {
 		return mtpDcOptionsMutex();
 	}
@@ -121,6 +121,7 @@ namespace MTP {
 		}
 	}
 	void ping();
+	QList<int32> prepareDownloadKeys(); // start auth key creation in download sessions for dcs without keys, returns those dcs
 	void cancel(mtpRequestId req);
 	void killSession(int32 dc);
 	void stopSession(int32 dc);
@@ -156,6 +157,9 @@ namespace MTP {
 	mtpKeysMap getKeys();
 	void setKey(int32 dc, mtpAuthKeyPtr key);
 
+	mtpConnectStats getConnectStats();
+	void setConnectStats(const mtpConnectStats &stats);
+
 	QReadWriteLock *dcOptionsMutex();
 
 };
@@ -249,6 +249,27 @@ namespace {
 		BN_CTX *ctx;
 	};
 
+	QMutex verifiedPrimesMutex;
+	QSet<QByteArray> verifiedPrimes; // dh_prime with g appended, that already passed the primality test
+
+	bool isPrimeAndGoodCached(const string &prime, int32 g) {
+		QByteArray key(prime.data(), prime.size());
+		key.append(char(g));
+		{
+			QMutexLocker lock(&verifiedPrimesMutex);
+			if (verifiedPrimes.contains(key)) return true;
+		}
+
+		_BigNumPrimeTest bnPrimeTest;
+		if (!bnPrimeTest.isPrimeAndGood(prime.data(), MTPMillerRabinIterCount, g)) {
+			return false;
+		}
+
+		QMutexLocker lock(&verifiedPrimesMutex);
+		verifiedPrimes.insert(key);
+		return true;
+	}
+
 	typedef QMap<uint64, mtpPublicRSA> PublicRSAKeys;
 	PublicRSAKeys gPublicRSA;
 
@@ -945,7 +966,8 @@ bool MTPautoConnection::usingHttpWait() {
 }
 
 bool MTPautoConnection::needHttpWait() {
-	return (status == UsingHttp) ? requests.isEmpty() : false;
+	// same as MTPhttpConnection::needHttpWait() when falling back to http
+	return (status == UsingHttp) ? (requests.size() < MTPHttpConcurrentRequests) : false;
 }
 
 int32 MTPautoConnection::debugState() const {
@@ -1161,7 +1183,7 @@ void MTPhttpConnection::sendData(mtpBuffer &buffer) {
     request.setHeader(QNetworkRequest::ContentTypeHeader, QVariant(qsl("application/x-www-form-urlencoded")));
 
 	TCP_LOG(("HTTP Info: sending %1 len request %2").arg(requestSize).arg(Logs::mb(&buffer[2], requestSize).str()));
-	requests.insert(manager.post(request, QByteArray((const char*)(&buffer[2]), requestSize)));
+	requests.insert(manager.post(request, QByteArray((const char*)(&buffer[2]), requestSize)), RequestInfo(getms(true), requestSize));
 }
 
 void MTPhttpConnection::disconnectFromServer() {
@@ -1171,8 +1193,8 @@ void MTPhttpConnection::disconnectFromServer() {
 	Requests copy = requests;
 	requests.clear();
 	for (Requests::const_iterator i = copy.cbegin(), e = copy.cend(); i != e; ++i) {
-		(*i)->abort();
-		(*i)->deleteLater();
+		i.key()->abort();
+		i.key()->deleteLater();
 	}
 
 	disconnect(&manager, SIGNAL(finished(QNetworkReply*)), this, SLOT(requestFinished(QNetworkReply*)));
@@ -1203,9 +1225,12 @@ void MTPhttpConnection::requestFinished(QNetworkReply *reply) {
 
 	reply->deleteLater();
 	if (reply->error() == QNetworkReply::NoError) {
-		requests.remove(reply);
+		RequestInfo info = requests.take(reply);
 
 		mtpBuffer data = _handleHttpResponse(reply);
+		if (info.sent) {
+			DEBUG_LOG(("HTTP Info: request done in %1ms, sent %2 bytes, received %3 bytes, %4 requests left").arg(getms(true) - info.sent).arg(info.size).arg(data.size() * sizeof(mtpPrime)).arg(requests.size()));
+		}
 		if (data.size() == 1) {
 			emit error();
 		} else if (!data.isEmpty()) {
@@ -1243,7 +1268,9 @@ bool MTPhttpConnection::usingHttpWait() {
 }
 
 bool MTPhttpConnection::needHttpWait() {
-	return requests.isEmpty();
+	// keep more than one long-poll open, so that while the server is answering
+	// one of them the other one is already waiting for the next updates
+	return (status == UsingHttp) ? (requests.size() < MTPHttpConcurrentRequests) : requests.isEmpty();
 }
 
 int32 MTPhttpConnection::debugState() const {
@@ -1332,6 +1359,8 @@ MTProtoConnectionPrivate::MTProtoConnectionPrivate(QThread *thread, MTProtoConne
 , _waitForReceived(MTPMinReceiveDelay)
 , _waitForConnected(MTPMinConnectDelay)
 , firstSentAt(-1)
+, _connectStartedAt(0)
+, _connected6At(0)
 , _pingId(0)
 , _pingIdToSend(0)
 , _pingSendAt(0)
@@ -1531,6 +1560,7 @@ void MTProtoConnectionPrivate::resetSession() { // recreate all msg_id and msg_s
 				mtpRequest req = j.value();
 				haveSent.erase(j);
 				haveSent.insert(i.value(), req);
+				sessionData->scheduleSentCheck(i.value(), req);
 			}
 			mtpRequestIdsMap::iterator k = toResend.find(i.key());
 			if (k != toResend.cend()) {
@@ -1627,6 +1657,7 @@ mtpMsgId MTProtoConnectionPrivate::replaceMsgId(mtpRequest &request, mtpMsgId ne
 				mtpRequest req = k.value();
 				haveSent.erase(k);
 				haveSent.insert(newId, req);
+				sessionData->scheduleSentCheck(newId, req);
 			}
 
 			for (k = haveSent.begin(); k != haveSent.cend(); ++k) {
@@ -1814,6 +1845,7 @@ void MTProtoConnectionPrivate::tryToSend() {
 					QWriteLocker locker2(sessionData->haveSentMutex());
 					mtpRequestMap &haveSent(sessionData->haveSentMap());
 					haveSent.insert(msgId, toSendRequest);
+					sessionData->scheduleSentCheck(msgId, toSendRequest);
 
 					if (needsLayer && !toSendRequest->needsLayer) needsLayer = false;
 					if (toSendRequest->after) {
@@ -1914,6 +1946,7 @@ void MTProtoConnectionPrivate::tryToSend() {
 							added = true;
 						}
 						haveSent.insert(msgId, req);
+						sessionData->scheduleSentCheck(msgId, req);
 
 						needAnyResponse = true;
 					} else {
@@ -1930,6 +1963,7 @@ void MTProtoConnectionPrivate::tryToSend() {
 				mtpMsgId msgId = placeToContainer(toSendRequest, bigMsgId, haveSentArr, stateRequest);
 				stateRequest->msDate = 0; // 0 for state request, do not request state of it
 				haveSent.insert(msgId, stateRequest);
+				sessionData->scheduleSentCheck(msgId, stateRequest);
 			}
 			if (resendRequest) placeToContainer(toSendRequest, bigMsgId, haveSentArr, resendRequest);
 			if (ackRequest) placeToContainer(toSendRequest, bigMsgId, haveSentArr, ackRequest);
@@ -1939,11 +1973,16 @@ void MTProtoConnectionPrivate::tryToSend() {
 			*(mtpMsgId*)(haveSentIdsWrap->data() + 4) = contMsgId;
 			(*haveSentIdsWrap)[6] = 0; // for container, msDate = 0, seqNo = 0
 			haveSent.insert(contMsgId, haveSentIdsWrap);
+			sessionData->scheduleSentCheck(contMsgId, haveSentIdsWrap);
 			toSend.clear();
 		}
 	}
 	mtpRequestData::padding(toSendRequest);
 	sendRequest(toSendRequest, needAnyResponse, lockFinished);
+
+	if (httpWaitRequest && _conn && _conn->needHttpWait()) { // top up the open long-polls to MTPHttpConcurrentRequests
+		emit sendHttpWaitAsync();
+	}
 }
 
 void MTProtoConnectionPrivate::retryByTimer() {
@@ -2071,6 +2110,8 @@ void MTProtoConnectionPrivate::socketStart(bool afterConfig) {
 	if (!noIPv4) DEBUG_LOG(("MTP Info: creating IPv4 connection to %1:%2 (tcp) and %3:%4 (http)..").arg(ip[IPv4address][TcpProtocol].c_str()).arg(port[IPv4address][TcpProtocol]).arg(ip[IPv4address][HttpProtocol].c_str()).arg(port[IPv4address][HttpProtocol]));
 	if (!noIPv6) DEBUG_LOG(("MTP Info: creating IPv6 connection to [%1]:%2 (tcp) and [%3]:%4 (http)..").arg(ip[IPv6address][TcpProtocol].c_str()).arg(port[IPv6address][TcpProtocol]).arg(ip[IPv4address][HttpProtocol].c_str()).arg(port[IPv4address][HttpProtocol]));
 
+	_connectStartedAt = getms(true);
+	_connected6At = 0;
 	_waitForConnectedTimer.start(_waitForConnected);
 	if (auto conn = _conn4) {
 		connect(conn, SIGNAL(connected()), this, SLOT(onConnected4()));
@@ -2205,6 +2246,7 @@ void MTProtoConnectionPrivate::onWaitReceivedFailed() {
 
 void MTProtoConnectionPrivate::onWaitConnectedFailed() {
 	DEBUG_LOG(("MTP Info: can't connect in %1ms").arg(_waitForConnected));
+	// no connect stats update, both failing means no network, not a bad address family
 	if (_waitForConnected < MTPMaxConnectDelay) _waitForConnected *= 2;
 
 	doDisconnect();
@@ -2215,11 +2257,18 @@ void MTProtoConnectionPrivate::onWaitConnectedFailed() {
 }
 
 void MTProtoConnectionPrivate::onWaitIPv4Failed() {
+	if (_conn4) mtpConnectFinished(dc, false, -1); // IPv6 succeeded while IPv4 did not
+
+	useConnected6();
+}
+
+void MTProtoConnectionPrivate::useConnected6() {
 	_conn = _conn6;
 	destroyConn(&_conn4);
 
 	if (_conn) {
 		DEBUG_LOG(("MTP Info: can't connect through IPv4, using IPv6 connection."));
+		connectDone(true);
 
 		updateAuthKey();
 	} else {
@@ -2277,6 +2326,7 @@ void MTProtoConnectionPrivate::handleReceived() {
 	while (_conn->received().size()) {
 		const mtpBuffer &encryptedBuf(_conn->received().front());
 		uint32 len = encryptedBuf.size();
+		STATS_ADD("mtp_received_bytes", len * sizeof(mtpPrime));
 		const mtpPrime *encrypted(encryptedBuf.data());
 		if (len < 18) { // 2 auth_key_id, 4 msg_key, 2 salt, 2 session, 2 msg_id, 1 seq_no, 1 length, (1 data + 3 padding) min
 			LOG(("TCP Error: bad message received, len %1").arg(len * sizeof(mtpPrime)));
@@ -2858,6 +2908,13 @@ int32 MTProtoConnectionPrivate::handleOneReceived(const mtpPrime *from, const mt
 		}
 
 		mtpRequestId requestId = wasSent(reqMsgId.v);
+		if (cDebug()) {
+			QReadLocker locker(sessionData->haveSentMutex());
+			mtpRequestMap::const_iterator i = sessionData->haveSentMap().constFind(reqMsgId.v);
+			if (i != sessionData->haveSentMap().cend() && i.value()->msDate > 0) {
+				Stats::add("mtp_rpc_ms", int64(getms(true) - i.value()->msDate));
+			}
+		}
 		if (requestId && requestId != mtpRequestId(0xFFFFFFFF)) {
 			QWriteLocker locker(sessionData->haveReceivedMutex());
 			sessionData->haveReceivedMap().insert(requestId, response); // save rpc_result for processing in main mtp thread
@@ -3205,6 +3262,7 @@ void MTProtoConnectionPrivate::onConnected4() {
 	destroyConn(&_conn6);
 
 	DEBUG_LOG(("MTP Info: connection through IPv4 succeed."));
+	connectDone(false);
 
 	lockFinished.unlock();
 	updateAuthKey();
@@ -3225,11 +3283,31 @@ void MTProtoConnectionPrivate::onConnected6() {
 		return restart();
 	}
 
+	_connected6At = getms(true);
+	if (!mtpConnectShouldWait(dc, false)) {
+		DEBUG_LOG(("MTP Info: connection through IPv6 succeed, IPv4 failed recently, not waiting for it."));
+
+		lockFinished.unlock();
+		return useConnected6(); // skipped wait is not an IPv4 fail
+	}
+
 	DEBUG_LOG(("MTP Info: connection through IPv6 succeed, waiting IPv4 for %1ms.").arg(MTPIPv4ConnectionWaitTimeout));
 
 	_waitForIPv4Timer.start(MTPIPv4ConnectionWaitTimeout);
 }
 
+void MTProtoConnectionPrivate::connectDone(bool ipv6) {
+	uint64 ms = getms(true);
+	if (_connected6At) {
+		mtpConnectFinished(dc, true, int32(_connected6At - _connectStartedAt));
+	}
+	if (!ipv6) {
+		mtpConnectFinished(dc, false, int32(ms - _connectStartedAt));
+	}
+	DEBUG_LOG(("MTP Info: connected through %1 in %2ms").arg(ipv6 ? "IPv6" : "IPv4").arg(ms - _connectStartedAt));
+	STATS_ADD("mtp_connect_ms", ms - _connectStartedAt);
+}
+
 void MTProtoConnectionPrivate::onDisconnected4() {
 	if (_conn && _conn == _conn6) return; // disconnected the unused
 
@@ -3493,9 +3571,8 @@ void MTProtoConnectionPrivate::dhParamsAnswered() {
 			return restart();
 		}
 
-		// check that dhPrime and (dhPrime - 1) / 2 are really prime using openssl BIGNUM methods
-		_BigNumPrimeTest bnPrimeTest;
-		if (!bnPrimeTest.isPrimeAndGood(&dhPrime[0], MTPMillerRabinIterCount, dh_inner_data.vg.v)) {
+		// check that dhPrime and (dhPrime - 1) / 2 are really prime using openssl BIGNUM methods, once per dhPrime
+		if (!isPrimeAndGoodCached(dhPrime, dh_inner_data.vg.v)) {
 			LOG(("AuthKey Error: bad dh_prime primality!").arg(dhPrime.length()).arg(g_a.length()));
 			DEBUG_LOG(("AuthKey Error: dh_prime %1").arg(Logs::mb(&dhPrime[0], dhPrime.length()).str()));
 			return restart();
@@ -3643,6 +3720,8 @@ void MTProtoConnectionPrivate::dhClientParamsAnswered() {
 		authKey->setDC(dc % _mtp_internal::dcShift);
 
 		DEBUG_LOG(("AuthKey Info: auth key gen succeed, id: %1, server salt: %2, auth key: %3").arg(authKey->keyId()).arg(serverSalt).arg(Logs::mb(authKeyData->auth_key, 256).str()));
+		DEBUG_LOG(("AuthKey Info: auth key for dc %1 created in %2ms").arg(dc % _mtp_internal::dcShift).arg(getms(true) - authKeyData->started));
+		STATS_ADD("mtp_auth_key_ms", getms(true) - authKeyData->started);
 
 		sessionData->owner()->notifyKeyCreated(authKey); // slot will call authKeyCreated()
 		sessionData->clear();
@@ -3899,6 +3978,7 @@ bool MTProtoConnectionPrivate::sendRequest(mtpRequest &request, bool needAnyResp
 
 	_conn->setSentEncrypted();
 	_conn->sendData(result);
+	STATS_ADD("mtp_sent_bytes", result.size() * sizeof(mtpPrime));
 
 	if (needAnyResponse) {
 		onSentSome(result.size() * sizeof(mtpPrime));
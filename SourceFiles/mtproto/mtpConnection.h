@@ -324,7 +324,13 @@ private:
 	QNetworkAccessManager manager;
 	QUrl address;
 
-	typedef QSet<QNetworkReply*> Requests;
+	struct RequestInfo {
+		RequestInfo(uint64 sent = 0, int32 size = 0) : sent(sent), size(size) {
+		}
+		uint64 sent;
+		int32 size;
+	};
+	typedef QMap<QNetworkReply*, RequestInfo> Requests;
 	Requests requests;
 
 };
@@ -412,6 +418,8 @@ private:
 
 	void createConn(bool createIPv4, bool createIPv6);
 	void destroyConn(MTPabstractConnection **conn = 0); // 0 - destory all
+	void connectDone(bool ipv6); // updates connect stats
+	void useConnected6();
 
 	mtpMsgId placeToContainer(mtpRequest &toSendRequest, mtpMsgId &bigMsgId, mtpMsgId *&haveSentArr, mtpRequest &req);
 	mtpMsgId prepareToSend(mtpRequest &request, mtpMsgId currentLastId);
@@ -447,6 +455,7 @@ private:
 	SingleTimer _waitForConnectedTimer, _waitForReceivedTimer, _waitForIPv4Timer;
 	uint32 _waitForReceived, _waitForConnected;
 	int64 firstSentAt;
+	uint64 _connectStartedAt, _connected6At; // for connect time stats
 
 	QVector<MTPlong> ackRequestData, resendRequestData;
 
@@ -487,7 +496,8 @@ private:
 		, retries(0)
 		, g(0)
 		, req_num(0)
-		, msgs_sent(0) {
+		, msgs_sent(0)
+		, started(getms(true)) {
 			memset(new_nonce_buf, 0, sizeof(new_nonce_buf));
 			memset(aesKey, 0, sizeof(aesKey));
 			memset(aesIV, 0, sizeof(aesIV));
@@ -509,6 +519,8 @@ private:
 
 		uint32 req_num; // sent not encrypted request number
 		uint32 msgs_sent;
+
+		uint64 started; // for key creation latency logging
 	};
 	struct AuthKeyCreateStrings {
 		QByteArray dh_prime;
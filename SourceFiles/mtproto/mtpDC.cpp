@@ -300,3 +300,47 @@ void mtpSetKey(int32 dcId, mtpAuthKeyPtr key) {
 	MTProtoDCPtr dc(new MTProtoDC(dcId, key));
 	gDCs.insert(dcId, dc);
 }
+
+namespace {
+	mtpConnectStats _connectStats;
+	QMutex _connectStatsMutex;
+
+	inline int32 _connectStatKey(int32 dc, bool ipv6) {
+		return (dc % _mtp_internal::dcShift) + (ipv6 ? (MTPDdcOption::flag_ipv6 * _mtp_internal::dcShift) : 0);
+	}
+}
+
+void mtpConnectFinished(int32 dc, bool ipv6, int32 ms) {
+	QMutexLocker lock(&_connectStatsMutex);
+	mtpConnectStat &stat(_connectStats[_connectStatKey(dc, ipv6)]);
+	if (ms < 0) {
+		++stat.failed;
+	} else {
+		stat.ms = stat.ms ? ((stat.ms * 3 + ms) / 4) : qMax(ms, 1);
+		stat.failed = 0;
+	}
+	stat.skipped = 0;
+}
+
+bool mtpConnectShouldWait(int32 dc, bool ipv6) {
+	QMutexLocker lock(&_connectStatsMutex);
+	mtpConnectStat &stat(_connectStats[_connectStatKey(dc, ipv6)]);
+	if (stat.failed < MTPIPv4FailsToSkipWait) {
+		return true;
+	}
+	if (++stat.skipped >= MTPIPv4SkipsToReprobe) {
+		stat.skipped = 0;
+		return true;
+	}
+	return false;
+}
+
+mtpConnectStats mtpGetConnectStats() {
+	QMutexLocker lock(&_connectStatsMutex);
+	return _connectStats;
+}
+
+void mtpSetConnectStats(const mtpConnectStats &stats) {
+	QMutexLocker lock(&_connectStatsMutex);
+	_connectStats = stats;
+}
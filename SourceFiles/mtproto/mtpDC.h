@@ -104,5 +104,19 @@ void mtpAuthed(int32 uid);
 mtpKeysMap mtpGetKeys();
 void mtpSetKey(int32 dc, mtpAuthKeyPtr key);
 
+struct mtpConnectStat { // connect history for dc over IPv4 or IPv6, kept across launches in mtp data
+	mtpConnectStat() : ms(0), failed(0), skipped(0) {
+	}
+	int32 ms; // smoothed connect time, 0 if never connected
+	int32 failed; // failed attempts in a row
+	int32 skipped; // connections that didn't wait for this family since the last probe, not saved
+};
+typedef QMap<int32, mtpConnectStat> mtpConnectStats; // dc + dcShift * MTPDdcOption::flag_ipv6 for IPv6 -> stat
+
+void mtpConnectFinished(int32 dc, bool ipv6, int32 ms); // ms < 0 for failed attempt
+bool mtpConnectShouldWait(int32 dc, bool ipv6); // false if it failed too often, true once in a while to probe it again
+mtpConnectStats mtpGetConnectStats();
+void mtpSetConnectStats(const mtpConnectStats &stats);
+
 void mtpUpdateDcOptions(const QVector<MTPDcOption> &options);
 QReadWriteLock *mtpDcOptionsMutex();
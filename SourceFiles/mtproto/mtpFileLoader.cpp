@@ -372,19 +372,222 @@ mtpFileLoader::mtpFileLoader(int32 dc, const uint64 &id, const uint64 &access, L
 	_queue = &i.value();
 }
 
+FileLoadStream::FileLoadStream(int32 size, const QString &fname) : _size(size)
+, _fname(fname)
+, _waitingOffset(-1)
+, _failed(false)
+, _aborted(false) {
+}
+
+bool FileLoadStream::complete() const {
+	QMutexLocker lock(&_mutex);
+	return unsafeLoaded(0, _size);
+}
+
+bool FileLoadStream::loaded(int32 offset, int32 length) const {
+	QMutexLocker lock(&_mutex);
+	return unsafeLoaded(offset, length);
+}
+
+bool FileLoadStream::unsafeLoaded(int32 offset, int32 length) const {
+	Parts::const_iterator i = _parts.upperBound(offset);
+	if (i == _parts.cbegin()) return (length <= 0);
+	--i;
+	return (i.value() >= offset + length);
+}
+
+int32 FileLoadStream::loadedSize() const {
+	QMutexLocker lock(&_mutex);
+	int32 result = 0;
+	for (Parts::const_iterator i = _parts.cbegin(), e = _parts.cend(); i != e; ++i) {
+		result += i.value() - i.key();
+	}
+	return result;
+}
+
+int32 FileLoadStream::firstMissing() const {
+	QMutexLocker lock(&_mutex);
+	Parts::const_iterator i = _parts.constFind(0);
+	return (i == _parts.cend()) ? 0 : i.value();
+}
+
+void FileLoadStream::feed(int32 offset, const char *bytes, int32 length) {
+	if (offset < 0 || offset >= _size || length <= 0) return;
+	length = qMin(length, _size - offset);
+
+	QMutexLocker lock(&_mutex);
+	if (_data.size() != _size) {
+		_data.resize(_size);
+	}
+	memcpy(_data.data() + offset, bytes, length);
+	unsafeAddPart(offset, length);
+}
+
+void FileLoadStream::written(int32 offset, int32 length) {
+	if (offset < 0 || offset >= _size || length <= 0) return;
+	length = qMin(length, _size - offset);
+
+	QMutexLocker lock(&_mutex);
+	unsafeAddPart(offset, length);
+}
+
+void FileLoadStream::unsafeAddPart(int32 offset, int32 length) {
+	int32 from = offset, till = offset + length;
+	Parts::iterator i = _parts.upperBound(from);
+	if (i != _parts.begin()) {
+		Parts::iterator prev = i - 1;
+		if (prev.value() >= from) {
+			from = prev.key();
+			till = qMax(till, prev.value());
+			_parts.erase(prev);
+		}
+	}
+	for (i = _parts.lowerBound(from); i != _parts.end() && i.key() <= till;) {
+		till = qMax(till, i.value());
+		i = _parts.erase(i);
+	}
+	_parts.insert(from, till);
+
+	_partLoaded.wakeAll();
+}
+
+QByteArray FileLoadStream::data() const {
+	QMutexLocker lock(&_mutex);
+	return _data;
+}
+
+void FileLoadStream::fail() {
+	QMutexLocker lock(&_mutex);
+	_failed = true;
+	_partLoaded.wakeAll();
+}
+
+int32 FileLoadStream::read(int32 offset, char *buffer, int32 length) {
+	if (offset < 0 || offset >= _size || length <= 0) return 0;
+	length = qMin(length, _size - offset);
+
+	QMutexLocker lock(&_mutex);
+	while (true) {
+		if (_failed || _aborted) {
+			return -1;
+		}
+		if (unsafeLoaded(offset, length)) {
+			break;
+		}
+		_waitingOffset = offset;
+		if (!_partLoaded.wait(&_mutex, FileLoadStreamWaitTimeout)) {
+			LOG(("Stream Error: waited too long for offset %1 of %2").arg(offset).arg(_size));
+			return -1;
+		}
+	}
+	if (_waitingOffset == offset) _waitingOffset = -1;
+	if (_fname.isEmpty()) {
+		memcpy(buffer, _data.constData() + offset, length);
+	} else {
+		if (!_file.isOpen()) {
+			_file.setFileName(_fname);
+			if (!_file.open(QIODevice::ReadOnly)) {
+				LOG(("Stream Error: could not open '%1' for reading").arg(_fname));
+				return -1;
+			}
+		}
+		if (!_file.seek(offset) || _file.read(buffer, length) != length) {
+			LOG(("Stream Error: could not read %1 bytes at offset %2 from '%3'").arg(length).arg(offset).arg(_fname));
+			return -1;
+		}
+	}
+	return length;
+}
+
+void FileLoadStream::abortReads() {
+	QMutexLocker lock(&_mutex);
+	_aborted = true;
+	_partLoaded.wakeAll();
+}
+
+bool FileLoadStream::aborted() const {
+	QMutexLocker lock(&_mutex);
+	return _aborted;
+}
+
+FileLoadStream *FileLoadStream::takeOver() {
+	QMutexLocker lock(&_mutex);
+	FileLoadStream *result = new FileLoadStream(_size, _fname);
+	result->_parts = _parts;
+	result->_failed = _failed;
+	result->_data = _data;
+	_data = QByteArray(); // aborted readers don't touch it, so it is moved without a copy
+	return result;
+}
+
+int32 FileLoadStream::takeWaitingOffset() {
+	QMutexLocker lock(&_mutex);
+	int32 result = _waitingOffset;
+	if (result >= 0 && unsafeLoaded(result, 1)) {
+		result = -1;
+	}
+	_waitingOffset = -1;
+	return result;
+}
+
 int32 mtpFileLoader::currentOffset(bool includeSkipped) const {
+	if (_stream) return _stream->loadedSize();
 	return (_fileIsOpen ? _file.size() : _data.size()) - (includeSkipped ? 0 : _skippedBytes);
 }
 
+FileLoadStreamPtr mtpFileLoader::stream() {
+	if (_stream && _stream->aborted()) { // the previous playback is stopped, readers of the new one start over
+		_stream = FileLoadStreamPtr(_stream->takeOver());
+	}
+	if (!_stream && !_complete && _size > 0 && _size <= MaxFileLoadStreamSize && _localStatus != LocalLoading) {
+		_stream = FileLoadStreamPtr(new FileLoadStream(_size, _fileIsOpen ? _fname : QString()));
+
+		// give the stream every part loaded so far, the holes are the parts still being requested
+		int32 limit = (_locationType == UnknownFileLocation) ? DownloadPartSize : DocumentDownloadPartSize;
+		if (_fileIsOpen) _file.flush();
+		for (int32 offset = 0; offset < _nextRequestOffset && offset < _size; offset += limit) {
+			if (_requestedOffsets.contains(offset)) continue;
+
+			int32 length = qMin(limit, _size - offset);
+			if (_fileIsOpen) {
+				_stream->written(offset, qMin(length, int32(_file.size()) - offset));
+			} else {
+				_stream->feed(offset, _data.constData() + offset, qMin(length, _data.size() - offset));
+			}
+		}
+		if (!_fileIsOpen) {
+			_data = QByteArray(); // the stream holds the loaded parts now
+		}
+	}
+	return _stream;
+}
+
+void mtpFileLoader::streamNextOffset(int32 limit) {
+	int32 waiting = _stream->takeWaitingOffset();
+	if (waiting >= 0) { // someone plays the file and waits for this part, load it first
+		_nextRequestOffset = waiting - (waiting % limit);
+	}
+	for (int32 tries = 0; tries < 2; ++tries) {
+		while (_nextRequestOffset < _size && (_requestedOffsets.contains(_nextRequestOffset) || _stream->loaded(_nextRequestOffset, qMin(limit, _size - _nextRequestOffset)))) {
+			_nextRequestOffset += limit;
+		}
+		if (_nextRequestOffset < _size) break;
+
+		int32 missing = _stream->firstMissing(); // return to the gap left behind a seek
+		_nextRequestOffset = missing - (missing % limit);
+	}
+}
+
 bool mtpFileLoader::loadPart() {
 	if (_complete || _lastComplete || (!_requests.isEmpty() && !_size)) return false;
+
+	int32 limit = (_locationType == UnknownFileLocation) ? DownloadPartSize : DocumentDownloadPartSize;
+	if (_stream) streamNextOffset(limit);
 	if (_size && _nextRequestOffset >= _size) return false;
 
-	int32 limit = DocumentDownloadPartSize;
 	MTPInputFileLocation loc;
 	if (_location) {
 		loc = MTP_inputFileLocation(MTP_long(_location->volume()), MTP_int(_location->local()), MTP_long(_location->secret()));
-		limit = DownloadPartSize;
 	} else {
 		switch (_locationType) {
 		case VideoFileLocation:
@@ -410,6 +613,7 @@ bool mtpFileLoader::loadPart() {
 	++_queue->queries;
 	dr.v[dcIndex] += limit;
 	_requests.insert(reqId, dcIndex);
+	_requestedOffsets.insert(offset);
 	_nextRequestOffset += limit;
 
 	return true;
@@ -428,7 +632,20 @@ void mtpFileLoader::partLoaded(int32 offset, const MTPupload_File &result, mtpRe
 
 	const MTPDupload_file &d(result.c_upload_file());
 	const string &bytes(d.vbytes.c_string().v);
-	if (bytes.size()) {
+	STATS_ADD("file_part_bytes", int64(bytes.size()));
+	_requestedOffsets.remove(offset);
+	if (_stream) { // the stream tracks loaded parts and holes, no skipped bytes accounting
+		if (bytes.size()) {
+			if (_fileIsOpen) {
+				if (!_file.seek(offset) || _file.write(bytes.data(), bytes.size()) != qint64(bytes.size()) || !_file.flush()) {
+					return cancel(true);
+				}
+				_stream->written(offset, bytes.size());
+			} else {
+				_stream->feed(offset, bytes.data(), bytes.size());
+			}
+		}
+	} else if (bytes.size()) {
 		if (_fileIsOpen) {
 			int64 fsize = _file.size();
 			if (offset < fsize) {
@@ -458,9 +675,15 @@ void mtpFileLoader::partLoaded(int32 offset, const MTPupload_File &result, mtpRe
 		}
 	}
 	if (!bytes.size() || (bytes.size() % 1024)) { // bad next offset
-		_lastComplete = true;
+		if (!_stream || !bytes.size() || _stream->complete()) { // the last part could be loaded before a gap left by a seek
+			_lastComplete = true;
+		}
 	}
-	if (_requests.isEmpty() && (_lastComplete || (_size && _nextRequestOffset >= _size))) {
+	bool allRequested = _stream ? _stream->complete() : (_size && _nextRequestOffset >= _size);
+	if (_requests.isEmpty() && (_lastComplete || allRequested)) {
+		if (_stream && !_fileIsOpen) {
+			_data = _stream->data();
+		}
 		if (!_fname.isEmpty() && (_toCache == LoadToCacheAsWell)) {
 			if (!_fileIsOpen) _fileIsOpen = _file.open(QIODevice::WriteOnly);
 			if (!_fileIsOpen) {
@@ -515,6 +738,10 @@ bool mtpFileLoader::partFailed(const RPCError &error) {
 }
 
 void mtpFileLoader::cancelRequests() {
+	if (_stream) {
+		_stream->fail();
+	}
+	_requestedOffsets.clear();
 	if (_requests.isEmpty()) return;
 
 	int32 limit = (_locationType == UnknownFileLocation) ? DownloadPartSize : DocumentDownloadPartSize;
@@ -669,13 +896,14 @@ webFileLoader::~webFileLoader() {
 
 class webFileLoaderPrivate {
 public:
-	webFileLoaderPrivate(webFileLoader *loader, const QString &url)
+	webFileLoaderPrivate(webFileLoader *loader, const QString &url, bool prior)
 		: _interface(loader)
 		, _url(url)
 		, _already(0)
 		, _size(0)
 		, _reply(0)
-		, _redirectsLeft(MaxHttpRedirects) {
+		, _redirectsLeft(MaxHttpRedirects)
+		, _prior(prior) {
 	}
 
 	QNetworkReply *reply() {
@@ -688,6 +916,7 @@ public:
 		QNetworkRequest req(_url);
 		QByteArray rangeHeaderValue = "bytes=" + QByteArray::number(_already) + "-";
 		req.setRawHeader("Range", rangeHeaderValue);
+		req.setPriority(_prior ? QNetworkRequest::HighPriority : QNetworkRequest::NormalPriority); // visible files go first in the per-host connections queue
 		_reply = manager.get(req);
 		return _reply;
 	}
@@ -712,6 +941,9 @@ public:
 	void setProgress(qint64 already, qint64 size) {
 		_already = already;
 		_size = qMax(size, 0LL);
+		if (_size > _data.capacity() && _size <= AnimationInMemory) {
+			_data.reserve(int32(_size)); // don't regrow the buffer on each received part
+		}
 	}
 
 	qint64 size() const {
@@ -727,6 +959,7 @@ private:
 	qint64 _already, _size;
 	QNetworkReply *_reply;
 	int32 _redirectsLeft;
+	bool _prior;
 	QByteArray _data;
 
 	friend class WebLoadManager;
@@ -775,7 +1008,7 @@ WebLoadManager::WebLoadManager(QThread *thread) {
 }
 
 void WebLoadManager::append(webFileLoader *loader, const QString &url) {
-	loader->_private = new webFileLoaderPrivate(loader, url);
+	loader->_private = new webFileLoaderPrivate(loader, url, loader->_priority == GlobalPriority);
 
 	QMutexLocker lock(&_loaderPointersMutex);
 	_loaderPointers.insert(loader, loader->_private);
@@ -880,6 +1113,7 @@ void WebLoadManager::onProgress(qint64 already, qint64 size) {
 		QByteArray r = reply->readAll();
 		if (!r.isEmpty()) {
 			loader->addData(r);
+			STATS_ADD("web_loaded_bytes", r.size());
 		}
 		if (size == 0) {
 			LOG(("Network Error: Zero size received for HTTP download progress in WebLoadManager::onProgress(): %1 / %2").arg(already).arg(size));
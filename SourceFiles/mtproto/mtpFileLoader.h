@@ -213,6 +213,51 @@ protected:
 
 };
 
+class FileLoadStream { // parts of a file being downloaded, can be read from any thread
+public:
+
+	FileLoadStream(int32 size, const QString &fname); // parts are read back from fname if it is not empty, else they are held in memory
+
+	int32 size() const {
+		return _size;
+	}
+	bool complete() const;
+	bool loaded(int32 offset, int32 length) const;
+	int32 loadedSize() const;
+	int32 firstMissing() const;
+
+	void feed(int32 offset, const char *bytes, int32 length); // holds the part in memory
+	void written(int32 offset, int32 length); // the part is already written and flushed to the file
+	QByteArray data() const; // the parts held in memory
+	void fail();
+
+	int32 read(int32 offset, char *buffer, int32 length); // blocks until the part is loaded, < 0 on fail or abort
+	void abortReads(); // wakes all waiting readers with a fail, all the later reads fail as well
+	bool aborted() const;
+	FileLoadStream *takeOver(); // a new stream with all the loaded parts to replace this aborted one
+	int32 takeWaitingOffset(); // offset some reader waits for or -1, should be requested first
+
+private:
+
+	bool unsafeLoaded(int32 offset, int32 length) const;
+	void unsafeAddPart(int32 offset, int32 length);
+
+	const int32 _size;
+	QString _fname;
+	QFile _file; // opened by the first read from fname
+	QByteArray _data;
+	typedef QMap<int32, int32> Parts; // offset -> end, adjacent parts are merged
+	Parts _parts;
+
+	int32 _waitingOffset;
+	bool _failed, _aborted;
+
+	mutable QMutex _mutex;
+	QWaitCondition _partLoaded;
+
+};
+typedef QSharedPointer<FileLoadStream> FileLoadStreamPtr;
+
 class StorageImageLocation;
 class mtpFileLoader : public FileLoader, public RPCSender {
 	Q_OBJECT
@@ -239,6 +284,8 @@ public:
 		rpcClear();
 	}
 
+	FileLoadStreamPtr stream(); // start feeding loaded parts to a stream for playing while downloading
+
 	~mtpFileLoader();
 
 protected:
@@ -257,6 +304,11 @@ protected:
 	int32 _skippedBytes;
 	int32 _nextRequestOffset;
 
+	QSet<int32> _requestedOffsets; // offsets of parts requested and not received yet
+
+	FileLoadStreamPtr _stream;
+	void streamNextOffset(int32 limit);
+
 	int32 _dc;
 	const StorageImageLocation *_location;
 
@@ -21,6 +21,56 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 #include "stdafx.h"
 #include <QtCore/QSharedPointer>
 
+MTPDeadlineWheel::MTPDeadlineWheel() : _tick(getms(true) / 1000) {
+}
+
+void MTPDeadlineWheel::add(mtpMsgId msgId, uint64 deadline) {
+	Deadline d = { deadline, msgId };
+	_slots[qMax(deadline / 1000, _tick) % MTPDeadlineWheelSlots].push_back(d);
+}
+
+void MTPDeadlineWheel::expire(uint64 ms, QVector<mtpMsgId> &result) {
+	uint64 tick = qMax(ms / 1000, _tick), till = qMin(tick, _tick + MTPDeadlineWheelSlots - 1); // each slot is visited once at most
+	for (uint64 t = _tick; t <= till; ++t) {
+		Slot &slot(_slots[t % MTPDeadlineWheelSlots]);
+		for (int32 i = 0; i < slot.size();) {
+			if (slot.at(i).ms <= ms) {
+				result.push_back(slot.at(i).msgId);
+				slot[i] = slot.back();
+				slot.pop_back();
+			} else {
+				++i;
+			}
+		}
+	}
+	_tick = tick;
+}
+
+void MTPDeadlineWheel::clear() {
+	for (int32 i = 0; i < MTPDeadlineWheelSlots; ++i) {
+		_slots[i].clear();
+	}
+	_tick = getms(true) / 1000;
+}
+
+void MTPSessionData::scheduleSentCheck(mtpMsgId msgId, const mtpRequest &request) {
+	uint64 ms = getms(true);
+	if (request->msDate > 0) {
+		sentChecks.add(msgId, qMax(request->msDate + MTPCheckResendTimeout + 1, ms));
+	} else { // containers and state requests are only removed when too old
+		int32 lives = (int32)(msgId >> 32) + MTPContainerLives - unixtime();
+		sentChecks.add(msgId, ms + (lives >= 0 ? (lives + 1) * 1000ULL : 0));
+	}
+}
+
+void MTPSessionData::sentChecksDue(uint64 ms, QVector<mtpMsgId> &result) {
+	sentChecks.expire(ms, result);
+	if (result.size() > 1) {
+		qSort(result); // resend in the order the requests were sent
+		result.erase(std::unique(result.begin(), result.end()), result.end()); // a resent msgId could be scheduled twice
+	}
+}
+
 void MTPSessionData::clear() {
 	RPCCallbackClears clearCallbacks;
 	{
@@ -49,6 +99,7 @@ void MTPSessionData::clear() {
 	{
 		QWriteLocker locker(haveSentMutex());
 		haveSent.clear();
+		sentChecks.clear();
 	}
 	{
 		QWriteLocker locker(toResendMutex());
@@ -232,28 +283,36 @@ void MTProtoSession::checkRequestsByTimer() {
 	QVector<mtpMsgId> stateRequestIds;
 
 	{
-		QReadLocker locker(data.haveSentMutex());
+		QWriteLocker locker(data.haveSentMutex());
 		mtpRequestMap &haveSent(data.haveSentMap());
-		uint32 haveSentCount(haveSent.size());
 		uint64 ms = getms(true);
-		for (mtpRequestMap::iterator i = haveSent.begin(), e = haveSent.end(); i != e; ++i) {
+
+		QVector<mtpMsgId> dueIds;
+		data.sentChecksDue(ms, dueIds);
+		for (int32 j = 0, l = dueIds.size(); j < l; ++j) {
+			mtpRequestMap::iterator i = haveSent.find(dueIds.at(j));
+			if (i == haveSent.end()) continue; // was acked, resent or removed already
+
 			mtpRequest &req(i.value());
 			if (req->msDate > 0) {
 				if (req->msDate + MTPCheckResendTimeout < ms) { // need to resend or check state
 					if (mtpRequestData::messageSize(req) < MTPResendThreshold) { // resend
-						resendingIds.reserve(haveSentCount);
 						resendingIds.push_back(i.key());
 					} else {
 						req->msDate = ms;
-						stateRequestIds.reserve(haveSentCount);
 						stateRequestIds.push_back(i.key());
+						data.scheduleSentCheck(i.key(), req);
 					}
+				} else { // msDate was updated after the check was scheduled
+					data.scheduleSentCheck(i.key(), req);
 				}
 			} else if (unixtime() > (int32)(i.key() >> 32) + MTPContainerLives) {
-				removingIds.reserve(haveSentCount);
 				removingIds.push_back(i.key());
+			} else {
+				data.scheduleSentCheck(i.key(), req);
 			}
 		}
+		STATS_ADD("mtp_deadlines_fired", dueIds.size());
 	}
 
 	if (stateRequestIds.size()) {
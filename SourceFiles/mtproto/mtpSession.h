@@ -26,6 +26,26 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 
 class MTProtoSession;
 
+class MTPDeadlineWheel { // hashed timer wheel for haveSent checks, expiring costs O(expired)
+public:
+
+	MTPDeadlineWheel();
+
+	void add(mtpMsgId msgId, uint64 deadline); // deadline in getms(true) ms
+	void expire(uint64 ms, QVector<mtpMsgId> &result); // appends msgIds with deadline <= ms
+	void clear();
+
+private:
+	struct Deadline {
+		uint64 ms;
+		mtpMsgId msgId;
+	};
+	typedef QVector<Deadline> Slot;
+	Slot _slots[MTPDeadlineWheelSlots];
+	uint64 _tick;
+
+};
+
 class MTPSessionData {
 public:
 
@@ -184,6 +204,9 @@ public:
 		return result * 2 + (needAck ? 1 : 0);
 	}
 
+	void scheduleSentCheck(mtpMsgId msgId, const mtpRequest &request); // must be locked by haveSentMutex() for write
+	void sentChecksDue(uint64 ms, QVector<mtpMsgId> &result); // must be locked by haveSentMutex() for write
+
 	void clear();
 
 private:
@@ -204,6 +227,7 @@ private:
 	mtpRequestIdsMap wereAcked; // map of msg_id -> request_id, this msg_ids already were acked or do not need ack
 	mtpResponseMap haveReceived; // map of request_id -> response, that should be processed in other thread
 	mtpMsgIdsSet stateRequest; // set of msg_id's, whose state should be requested
+	MTPDeadlineWheel sentChecks; // msg_id's from haveSent by the time they should be resent, state requested or removed
 
 	// mutexes
 	mutable QReadWriteLock lock;
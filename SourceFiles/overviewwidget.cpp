@@ -46,6 +46,8 @@ OverviewInner::OverviewInner(OverviewWidget *overview, ScrollArea *scroll, PeerD
 , _selMode(false)
 , _rowsLeft(0)
 , _rowWidth(st::msgMinWidth)
+, _cachedFrom(0)
+, _cachedTill(0)
 , _search(this, st::dlgFilter, lang(lng_dlg_filter))
 , _cancelSearch(this, st::btnCancelSearch)
 , _itemsToBeLoaded(LinksOverviewPerPage * 2)
@@ -178,6 +180,55 @@ MsgId OverviewInner::itemMsgId(MsgId msgId) const {
 	return itemMigrated(msgId) ? -msgId : msgId;
 }
 
+int32 OverviewInner::listItemBottom(int32 j) const {
+	int32 l = _items.size(), i = _reversed ? (l - j - 1) : j, nexti = _reversed ? (i - 1) : (i + 1);
+	int32 nextItemTop = (j + 1 == l) ? (_reversed ? 0 : _height) : _items.at(nexti)->Get<OverviewItemInfo>()->top();
+	if (_reversed) nextItemTop = _height - nextItemTop;
+	return _marginTop + nextItemTop;
+}
+
+int32 OverviewInner::firstListItemBelow(int32 y) const {
+	// item bottoms grow in the display order, so binary search instead of walking from the first item
+	int32 from = 0, till = _items.size();
+	while (from < till) {
+		int32 j = (from + till) / 2;
+		if (listItemBottom(j) > y) {
+			till = j;
+		} else {
+			from = j + 1;
+		}
+	}
+	return from;
+}
+
+void OverviewInner::clearFarCaches() {
+	int32 visibleHeight = _scroll->height();
+	int32 top = _scroll->scrollTop() - MediaOverviewCachedScreens * visibleHeight, bottom = _scroll->scrollTop() + (MediaOverviewCachedScreens + 1) * visibleHeight;
+	int32 count = _items.size(), from = 0, till = 0;
+	if (_type == OverviewPhotos || _type == OverviewVideos) {
+		int32 rowsCount = (_photosToAdd + count) / _photosInRow + (((_photosToAdd + count) % _photosInRow) ? 1 : 0);
+		int32 rowFrom = floorclamp(top - _marginTop - st::overviewPhotoSkip, _rowWidth + st::overviewPhotoSkip, 0, rowsCount);
+		int32 rowTo = ceilclamp(bottom - _marginTop - st::overviewPhotoSkip, _rowWidth + st::overviewPhotoSkip, 0, rowsCount);
+		from = qMax(count - rowTo * _photosInRow + _photosToAdd, 0);
+		till = qMin(count - rowFrom * _photosInRow + _photosToAdd, count);
+	} else {
+		int32 jFrom = firstListItemBelow(top), jTill = qMin(firstListItemBelow(bottom) + 1, count);
+		from = _reversed ? (count - jTill) : jFrom;
+		till = _reversed ? (count - jFrom) : jTill;
+	}
+	if (from > till) from = till;
+
+	// only the items that left the kept window are touched, so the cost doesn't grow with the items count
+	for (int32 i = _cachedFrom, l = qMin(_cachedTill, from); i < l; ++i) {
+		_items.at(i)->clearCache();
+	}
+	for (int32 i = qMax(_cachedFrom, till), l = qMin(_cachedTill, count); i < l; ++i) {
+		_items.at(i)->clearCache();
+	}
+	_cachedFrom = from;
+	_cachedTill = till;
+}
+
 int32 OverviewInner::migratedIndexSkip() const {
 	return (_migrated && _history->overviewLoaded(_type)) ? _migrated->overview[_type].size() : 0;
 }
@@ -758,6 +809,7 @@ void OverviewInner::clear() {
 	}
 	_layoutDates.clear();
 	_items.clear();
+	_cachedFrom = _cachedTill = 0;
 }
 
 int32 OverviewInner::itemTop(const FullMsgId &msgId) const {
@@ -877,23 +929,21 @@ void OverviewInner::paintEvent(QPaintEvent *e) {
 	} else {
 		p.translate(_rowsLeft, _marginTop);
 		int32 y = 0, w = _rowWidth;
-		for (int32 j = 0, l = _items.size(); j < l; ++j) {
-			int32 i = _reversed ? (l - j - 1) : j, nexti = _reversed ? (i - 1) : (i + 1);
-			int32 nextItemTop = (j + 1 == l) ? (_reversed ? 0 : _height) : _items.at(nexti)->Get<OverviewItemInfo>()->top();
-			if (_reversed) nextItemTop = _height - nextItemTop;
-			if (_marginTop + nextItemTop > r.top()) {
-				OverviewItemInfo *info = _items.at(i)->Get<OverviewItemInfo>();
-				int32 curY = info->top();
-				if (_reversed) curY = _height - curY;
-				if (_marginTop + curY >= r.y() + r.height()) break;
-
-				context.isAfterDate = (j > 0) ? !_items.at(j - 1)->toLayoutMediaItem() : false;
-				p.translate(0, curY - y);
-				_items.at(i)->paint(p, r.translated(-_rowsLeft, -_marginTop - curY), itemSelectedValue(i), &context);
-				y = curY;
-			}
+		for (int32 j = firstListItemBelow(r.top()), l = _items.size(); j < l; ++j) {
+			int32 i = _reversed ? (l - j - 1) : j;
+			OverviewItemInfo *info = _items.at(i)->Get<OverviewItemInfo>();
+			int32 curY = info->top();
+			if (_reversed) curY = _height - curY;
+			if (_marginTop + curY >= r.y() + r.height()) break;
+
+			context.isAfterDate = (j > 0) ? !_items.at(j - 1)->toLayoutMediaItem() : false;
+			p.translate(0, curY - y);
+			_items.at(i)->paint(p, r.translated(-_rowsLeft, -_marginTop - curY), itemSelectedValue(i), &context);
+			y = curY;
 		}
 	}
+
+	clearFarCaches();
 }
 
 void OverviewInner::mouseMoveEvent(QMouseEvent *e) {
@@ -941,12 +991,10 @@ void OverviewInner::onUpdateSelected() {
 			}
 		}
 	} else {
-		for (int32 j = 0, l = _items.size(); j < l; ++j) {
+		for (int32 l = _items.size(), j = qMax(qMin(firstListItemBelow(m.y()), l - 1), 0); j < l; ++j) {
 			bool lastItem = (j + 1 == l);
-			int32 i = _reversed ? (l - j - 1) : j, nexti = _reversed ? (i - 1) : (i + 1);
-			int32 nextItemTop = lastItem ? (_reversed ? 0 : _height) : _items.at(nexti)->Get<OverviewItemInfo>()->top();
-			if (_reversed) nextItemTop = _height - nextItemTop;
-			if (_marginTop + nextItemTop > m.y() || lastItem) {
+			int32 i = _reversed ? (l - j - 1) : j;
+			if (listItemBottom(j) > m.y() || lastItem) {
 				int32 top = _items.at(i)->Get<OverviewItemInfo>()->top();
 				if (_reversed) top = _height - top;
 				if (!_items.at(i)->toLayoutMediaItem()) { // day item
@@ -1753,6 +1801,9 @@ void OverviewInner::mediaOverviewUpdated() {
 	fixItemIndex(_mousedItemIndex, _mousedItem);
 	fixItemIndex(_dragItemIndex, _dragItem);
 
+	_cachedFrom = 0; // indices could change, check all items on the next paint
+	_cachedTill = _items.size();
+
 	recountMargins();
 	int32 newHeight = _marginTop + _height + _marginBottom, deltaHeight = newHeight - height();
 	if (deltaHeight) {
@@ -1805,6 +1856,8 @@ void OverviewInner::itemRemoved(HistoryItem *item) {
 		int32 index = _items.indexOf(j.value());
 		if (index >= 0) {
 			_items.remove(index);
+			_cachedFrom = 0; // indices have shifted, check all items on the next paint
+			_cachedTill = _items.size();
 		}
 		delete j.value();
 		_layoutItems.erase(j);
@@ -121,6 +121,9 @@ private:
 	void fixItemIndex(int32 &current, MsgId msgId) const;
 	bool itemHasPoint(MsgId msgId, int32 index, int32 x, int32 y) const;
 	int32 itemHeight(MsgId msgId, int32 index) const;
+	int32 listItemBottom(int32 j) const; // for not photos / videos, j is the index in the display order
+	int32 firstListItemBelow(int32 y) const;
+	void clearFarCaches();
 	void moveToNextItem(MsgId &msgId, int32 &index, MsgId upTo, int32 delta) const;
 
 	void updateDragSelection(MsgId dragSelFrom, int32 dragSelFromIndex, MsgId dragSelTo, int32 dragSelToIndex, bool dragSelecting);
@@ -154,6 +157,7 @@ private:
 
 	typedef QVector<LayoutItem*> Items;
 	Items _items;
+	int32 _cachedFrom, _cachedTill; // only _items in [_cachedFrom, _cachedTill) may hold cached pixmaps
 	typedef QMap<HistoryItem*, LayoutMediaItem*> LayoutItems;
 	LayoutItems _layoutItems;
 	typedef QMap<int32, LayoutOverviewDate*> LayoutDates;
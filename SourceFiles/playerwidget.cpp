@@ -296,14 +296,9 @@ void PlayerWidget::findCurrent() {
 	_index = -1;
 	if (!_history) return;
 
-	const History::MediaOverview *o = &(_msgmigrated ? _migrated : _history)->overview[OverviewMusicFiles];
-	if ((_msgmigrated ? _migrated : _history)->channelId() == _song.msgId.channel) {
-		for (int i = 0, l = o->size(); i < l; ++i) {
-			if (o->at(i) == _song.msgId.msg) {
-				_index = i;
-				break;
-			}
-		}
+	History *history = _msgmigrated ? _migrated : _history;
+	if (history->channelId() == _song.msgId.channel) {
+		_index = history->overviewIndexOf(OverviewMusicFiles, _song.msgId.msg);
 	}
 	preloadNext();
 }
@@ -352,12 +347,9 @@ void PlayerWidget::mediaOverviewUpdated(PeerData *peer, MediaOverviewType type)
 		_index = -1;
 		History *history = _msgmigrated ? _migrated : _history;
 		if (history->channelId() == _song.msgId.channel) {
-			for (int i = 0, l = history->overview[OverviewMusicFiles].size(); i < l; ++i) {
-				if (history->overview[OverviewMusicFiles].at(i) == _song.msgId.msg) {
-					_index = i;
-					preloadNext();
-					break;
-				}
+			_index = history->overviewIndexOf(OverviewMusicFiles, _song.msgId.msg);
+			if (_index >= 0) {
+				preloadNext();
 			}
 		}
 		updateControls();
@@ -811,11 +811,20 @@ void SettingsInner::keyPressEvent(QKeyEvent *e) {
 			Ui::showLayer(box);
 			from = size;
 			break;
+		} else if (str == qstr("debugstats")) {
+			QString path = cDebug() ? Stats::dump() : QString();
+			if (path.isEmpty()) {
+				Ui::showLayer(new InformBox(cDebug() ? qsl("Could not write stats file!") : qsl("Stats are collected only with DEBUG logs enabled.")));
+			} else {
+				Ui::showLayer(new InformBox(qsl("Stats saved to %1\n\n%2").arg(QDir::toNativeSeparators(path)).arg(Stats::json())));
+			}
+			from = size;
+			break;
         } else if (str == qstr("loadlang")) {
             chooseCustomLang();
 		} else if (str == qstr("crashplease")) {
 			t_assert(!"Crashed in Settings!");
-		} else if (qsl("debugmode").startsWith(str) || qsl("testmode").startsWith(str) || qsl("loadlang").startsWith(str) || qsl("crashplease").startsWith(str)) {
+		} else if (qsl("debugmode").startsWith(str) || qsl("debugstats").startsWith(str) || qsl("testmode").startsWith(str) || qsl("loadlang").startsWith(str) || qsl("crashplease").startsWith(str)) {
 			break;
 		}
 		++from;
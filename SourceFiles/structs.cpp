@@ -45,6 +45,19 @@ namespace {
 		hashMd5(both.constData(), both.size(), md5);
 		return (md5[peerId & 0x0F] & (peerIsUser(peer) ? 0x07 : 0x03));
 	}
+
+	typedef QSet<QString> NameTokensPool;
+	NameTokensPool _nameTokensPool; // all peers share one copy of each folded name token
+
+	QString internNameToken(const QString &token) {
+		NameTokensPool::const_iterator i = _nameTokensPool.constFind(token);
+		if (i != _nameTokensPool.cend()) {
+			STATS_ADD("peer_name_tokens_shared", 1);
+			return *i;
+		}
+		STATS_ADD("peer_name_tokens_bytes", token.size() * sizeof(QChar));
+		return *_nameTokensPool.insert(token);
+	}
 }
 
 style::color peerColor(int32 index) {
@@ -196,8 +209,6 @@ void UserData::setPhoto(const MTPUserProfilePhoto &p) { // see Local::readPeer a
 }
 
 void PeerData::fillNames() {
-	names.clear();
-	chars.clear();
 	QString toIndex = textAccentFold(name);
 	if (cRussianLetters().match(toIndex).hasMatch()) {
 		toIndex += ' ' + translitRusEng(toIndex);
@@ -211,8 +222,22 @@ void PeerData::fillNames() {
 	toIndex += ' ' + rusKeyboardLayoutSwitch(toIndex);
 
 	QStringList namesList = toIndex.toLower().split(cWordSplit(), QString::SkipEmptyParts);
-	for (QStringList::const_iterator i = namesList.cbegin(), e = namesList.cend(); i != e; ++i) {
-		names.insert(*i);
+	std::sort(namesList.begin(), namesList.end());
+	namesList.erase(std::unique(namesList.begin(), namesList.end()), namesList.end());
+	if (namesList.size() == names.size() && std::equal(namesList.cbegin(), namesList.cend(), names.cbegin())) {
+		return; // same tokens, names and chars are up to date
+	}
+
+	Names newNames;
+	newNames.reserve(namesList.size());
+	for (Names::const_iterator i = names.cbegin(), e = names.cend(), j = namesList.cbegin(), f = namesList.cend(); j != f; ++j) {
+		while (i != e && *i < *j) ++i;
+		newNames.push_back((i != e && *i == *j) ? *i : internNameToken(*j));
+	}
+	names = newNames;
+
+	chars.clear();
+	for (Names::const_iterator i = names.cbegin(), e = names.cend(); i != e; ++i) {
 		chars.insert(i->at(0));
 	}
 }
@@ -896,14 +921,51 @@ void DocumentOpenLink::doOpen(DocumentData *data, ActionOnLoad action) {
 	data->save(filename, action, item ? item->fullId() : FullMsgId());
 }
 
+void DocumentOpenLink::playWhileLoading(DocumentData *data) {
+	HistoryItem *item = App::hoveredLinkItem() ? App::hoveredLinkItem() : (App::contextItem() ? App::contextItem() : 0);
+	if (!item || !audioPlayer() || (!data->voice() && !data->song())) return;
+	if (!data->loadStream()) return;
+
+	if (data->voice()) {
+		AudioMsgId playing;
+		AudioPlayerState playingState = AudioPlayerStopped;
+		audioPlayer()->currentState(&playing, &playingState);
+		if (playing.msgId == item->fullId() && !(playingState & AudioPlayerStoppedMask) && playingState != AudioPlayerFinishing) {
+			audioPlayer()->pauseresume(OverviewVoiceFiles);
+			return;
+		}
+
+		AudioMsgId audio(data, item->fullId());
+		audioPlayer()->play(audio);
+		if (App::main()) {
+			App::main()->audioPlayProgress(audio);
+			App::main()->mediaMarkRead(data);
+		}
+	} else if (data->song()) {
+		SongMsgId playing;
+		AudioPlayerState playingState = AudioPlayerStopped;
+		audioPlayer()->currentState(&playing, &playingState);
+		if (playing.msgId == item->fullId() && !(playingState & AudioPlayerStoppedMask) && playingState != AudioPlayerFinishing) {
+			audioPlayer()->pauseresume(OverviewFiles);
+			return;
+		}
+
+		SongMsgId song(data, item->fullId());
+		audioPlayer()->play(song);
+		if (App::main()) App::main()->documentPlayProgress(song);
+	}
+}
+
 void DocumentOpenLink::onClick(Qt::MouseButton button) const {
 	if (button != Qt::LeftButton) return;
 	doOpen(document(), document()->voice() ? ActionOnLoadNone : ActionOnLoadOpen);
+	playWhileLoading(document());
 }
 
 void VoiceSaveLink::onClick(Qt::MouseButton button) const {
 	if (button != Qt::LeftButton) return;
 	doOpen(document(), ActionOnLoadNone);
+	playWhileLoading(document());
 }
 
 void GifOpenLink::onClick(Qt::MouseButton button) const {
@@ -1122,7 +1184,7 @@ void DocumentData::performActionOnLoad() {
 			AudioPlayerState state = AudioPlayerStopped;
 			audioPlayer()->currentState(&playing, &state);
 			if (playing.msgId == _actionOnLoadMsgId && !(state & AudioPlayerStoppedMask) && state != AudioPlayerFinishing) {
-				audioPlayer()->pauseresume(OverviewVoiceFiles);
+				// already playing while downloading
 			} else {
 				audioPlayer()->play(AudioMsgId(this, _actionOnLoadMsgId));
 				if (App::main()) App::main()->mediaMarkRead(this);
@@ -1134,7 +1196,7 @@ void DocumentData::performActionOnLoad() {
 			AudioPlayerState playingState = AudioPlayerStopped;
 			audioPlayer()->currentState(&playing, &playingState);
 			if (playing.msgId == item->fullId() && !(playingState & AudioPlayerStoppedMask) && playingState != AudioPlayerFinishing) {
-				audioPlayer()->pauseresume(OverviewFiles);
+				// already playing while downloading
 			} else {
 				SongMsgId song(this, item->fullId());
 				audioPlayer()->play(song);
@@ -1321,6 +1383,10 @@ QByteArray DocumentData::data() const {
 	return _data;
 }
 
+FileLoadStreamPtr DocumentData::loadStream() const {
+	return (loading() && !_loader->done()) ? _loader->stream() : FileLoadStreamPtr();
+}
+
 const FileLocation &DocumentData::location(bool check) const {
 	if (check && !_location.check()) {
 		const_cast<DocumentData*>(this)->_location = Local::readFileLocation(mediaKey());
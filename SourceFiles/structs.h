@@ -262,8 +262,8 @@ public:
 
 	QString name;
 	Text nameText;
-	typedef QSet<QString> Names;
-	Names names; // for filtering
+	typedef QVector<QString> Names;
+	Names names; // for filtering, sorted unique tokens shared between peers
 	typedef QSet<QChar> NameFirstChars;
 	NameFirstChars chars;
 
@@ -927,6 +927,7 @@ public:
 
 	QString already(bool check = false) const;
 	QByteArray data() const;
+	FileLoadStreamPtr loadStream() const; // parts loaded so far, for playing while downloading
 	const FileLocation &location(bool check = false) const;
 	void setLocation(const FileLocation &loc);
 
@@ -1113,6 +1114,10 @@ public:
 	static void doOpen(DocumentData *document, ActionOnLoad action = ActionOnLoadOpen);
 	void onClick(Qt::MouseButton button) const;
 
+protected:
+
+	static void playWhileLoading(DocumentData *document); // clicked voice or song starts playing from the parts being downloaded
+
 };
 
 class VoiceSaveLink : public DocumentOpenLink {
@@ -1051,6 +1051,129 @@ const InterfacesMetadata *GetInterfacesMetadata(uint64 mask) {
 	return i.value();
 }
 
+namespace {
+	const size_t SlabGranularity = 16, SlabMaxSize = 512, SlabChunkSize = 16 * 1024;
+	const size_t SlabClassesCount = SlabMaxSize / SlabGranularity;
+
+	struct SlabFreeItem {
+		SlabFreeItem *next;
+	};
+
+	// each chunk serves one size class and is released when its last block is freed
+	struct SlabChunk {
+		char *data;
+		size_t carved;
+		int32 used;
+		SlabFreeItem *free;
+		SlabChunk *prev, *next; // in SlabAvailable list of its class while it has free blocks
+	};
+	SlabChunk *SlabAvailable[SlabClassesCount] = { 0 };
+
+	typedef QMap<const char*, SlabChunk*> SlabChunks; // by data address, to find the chunk of a freed block
+	SlabChunks SlabChunksMap;
+
+	inline size_t slabClass(size_t size) {
+		return (size + SlabGranularity - 1) / SlabGranularity - 1;
+	}
+
+	inline void slabCheckThread() {
+		QCoreApplication *app = QCoreApplication::instance();
+		t_assert(!app || QThread::currentThread() == app->thread());
+	}
+
+	void slabLink(size_t cls, SlabChunk *chunk) {
+		chunk->prev = 0;
+		chunk->next = SlabAvailable[cls];
+		if (chunk->next) chunk->next->prev = chunk;
+		SlabAvailable[cls] = chunk;
+	}
+
+	void slabUnlink(size_t cls, SlabChunk *chunk) {
+		if (chunk->prev) {
+			chunk->prev->next = chunk->next;
+		} else {
+			SlabAvailable[cls] = chunk->next;
+		}
+		if (chunk->next) chunk->next->prev = chunk->prev;
+		chunk->prev = chunk->next = 0;
+	}
+}
+
+void *SlabAlloc(size_t size) {
+	if (!size || size > SlabMaxSize) {
+		void *result = malloc(size);
+		if (!result) { // terminate if we can't allocate memory
+			throw "Can't allocate memory!";
+		}
+		return result;
+	}
+	slabCheckThread();
+
+	size_t cls = slabClass(size), rounded = (cls + 1) * SlabGranularity;
+	SlabChunk *chunk = SlabAvailable[cls];
+	if (!chunk) {
+		chunk = new SlabChunk();
+		chunk->data = static_cast<char*>(malloc(SlabChunkSize));
+		if (!chunk->data) { // terminate if we can't allocate memory
+			throw "Can't allocate memory!";
+		}
+		chunk->carved = 0;
+		chunk->used = 0;
+		chunk->free = 0;
+		SlabChunksMap.insert(chunk->data, chunk);
+		slabLink(cls, chunk);
+		STATS_ADD("slab_bytes", SlabChunkSize);
+	}
+
+	void *result;
+	if (chunk->free) {
+		result = chunk->free;
+		chunk->free = chunk->free->next;
+	} else {
+		result = chunk->data + chunk->carved;
+		chunk->carved += rounded;
+	}
+	++chunk->used;
+	if (!chunk->free && chunk->carved + rounded > SlabChunkSize) { // chunk is full
+		slabUnlink(cls, chunk);
+	}
+	return result;
+}
+
+void SlabFree(void *p, size_t size) {
+	if (!p) return;
+	if (!size || size > SlabMaxSize) {
+		free(p);
+		return;
+	}
+	slabCheckThread();
+
+	const char *ptr = static_cast<const char*>(p);
+	SlabChunks::iterator i = SlabChunksMap.upperBound(ptr);
+	t_assert(i != SlabChunksMap.begin());
+	--i;
+	SlabChunk *chunk = i.value();
+	t_assert(ptr < chunk->data + SlabChunkSize);
+
+	size_t cls = slabClass(size), rounded = (cls + 1) * SlabGranularity;
+	bool wasFull = !chunk->free && chunk->carved + rounded > SlabChunkSize;
+
+	SlabFreeItem *item = static_cast<SlabFreeItem*>(p);
+	item->next = chunk->free;
+	chunk->free = item;
+	--chunk->used;
+
+	if (wasFull) {
+		slabLink(cls, chunk);
+	} else if (!chunk->used && (chunk->prev || chunk->next)) { // keep the last available chunk of the class to avoid thrashing
+		slabUnlink(cls, chunk);
+		SlabChunksMap.erase(i);
+		free(chunk->data);
+		delete chunk;
+		STATS_ADD("slab_bytes", -int64(SlabChunkSize));
+	}
+}
+
 const InterfacesMetadata *Interfaces::ZeroInterfacesMetadata = GetInterfacesMetadata(0);
 
 InterfaceWrapStruct InterfaceWraps[64];
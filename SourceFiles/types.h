@@ -655,6 +655,11 @@ private:
 
 const InterfacesMetadata *GetInterfacesMetadata(uint64 mask);
 
+// size-classed slabs for small objects created in big numbers on the main
+// thread (history items, their interfaces data), empty chunks are released
+void *SlabAlloc(size_t size);
+void SlabFree(void *p, size_t size);
+
 class Interfaces {
 public:
 
@@ -662,12 +667,7 @@ public:
 		if (mask) {
 			const InterfacesMetadata *meta = GetInterfacesMetadata(mask);
 			int32 size = sizeof(const InterfacesMetadata *) + meta->size;
-			void *data = malloc(size);
-			if (!data) { // terminate if we can't allocate memory
-				throw "Can't allocate memory!";
-			}
-
-			_data = data;
+			_data = SlabAlloc(size);
 			_meta() = meta;
 			for (int i = 0; i < meta->last; ++i) {
 				int offset = meta->offsets[i];
@@ -713,7 +713,7 @@ public:
 					InterfaceWraps[i].Destruct(_dataptrunsafe(offset));
 				}
 			}
-			free(_data);
+			SlabFree(_data, sizeof(const InterfacesMetadata *) + meta->size);
 		}
 	}
 
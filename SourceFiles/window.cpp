@@ -82,6 +82,8 @@ NotifyWindow::NotifyWindow(HistoryItem *msg, int32 x, int32 y, int32 fwdCount) :
 , history(msg->history())
 , item(msg)
 , fwdCount(fwdCount)
+, _msgsCount(fwdCount)
+, _updatedAt(getms(true))
 #ifdef Q_OS_WIN
 , started(GetTickCount())
 #endif
@@ -210,7 +212,13 @@ void NotifyWindow::updateNotifyDisplay() {
 			const HistoryItem *textCachedFor = 0;
 			Text itemTextCache(itemWidth);
 			QRect r(st::notifyPhotoPos.x() + st::notifyPhotoSize + st::notifyTextLeft, st::notifyItemTop + st::msgNameFont->height, itemWidth, 2 * st::dlgFont->height);
-			if (fwdCount < 2) {
+			if (_msgsCount > fwdCount) {
+				bool active = false;
+				item->drawInDialog(p, QRect(r.left(), r.top(), r.width(), st::dlgFont->height), active, textCachedFor, itemTextCache);
+				p.setFont(st::dlgHistFont->f);
+				p.setPen(st::dlgSystemColor->p);
+				p.drawText(r.left(), r.top() + st::dlgFont->height + st::dlgHistFont->ascent, lng_notification_new_messages(lt_count, _msgsCount));
+			} else if (fwdCount < 2) {
 				bool active = false;
 				item->drawInDialog(p, r, active, textCachedFor, itemTextCache);
 			} else {
@@ -257,6 +265,17 @@ void NotifyWindow::updatePeerPhoto() {
 	}
 }
 
+void NotifyWindow::mergeItems(HistoryItem *last, int32 count) {
+	item = last;
+	fwdCount = 1;
+	_msgsCount += count;
+	_updatedAt = getms(true);
+	updateNotifyDisplay();
+	if (hideTimer.isActive()) {
+		hideTimer.start(st::notifyWaitLongHide);
+	}
+}
+
 void NotifyWindow::itemRemoved(HistoryItem *del) {
 	if (item == del) {
 		item = 0;
@@ -383,6 +402,7 @@ Window::Window(QWidget *parent) : PsMainWindow(parent)
 , dragging(false)
 , _inactivePress(false)
 , _shouldLockAt(0)
+, _lastNotifySoundAt(0)
 , _mediaView(0) {
 
 	icon16 = icon256.scaledToWidth(16, Qt::SmoothTransformation);
@@ -1570,7 +1590,12 @@ void Window::notifyShowNext(NotifyWindow *remove) {
 	}
 	if (alert) {
 		psFlash();
-		App::playSound();
+		if (!_lastNotifySoundAt || ms >= _lastNotifySoundAt + NotifySoundMinDelay) {
+			App::playSound();
+			_lastNotifySoundAt = ms;
+		} else {
+			STATS_ADD("notify_sounds_skipped", 1);
+		}
 	}
 
     if (cCustomNotifies()) {
@@ -1677,10 +1702,40 @@ void Window::notifyShowNext(NotifyWindow *remove) {
 				}
 
 				if (cCustomNotifies()) {
-					NotifyWindow *notify = new NotifyWindow(notifyItem, x, y, fwdCount);
-					notifyWindows.push_back(notify);
-					psNotifyShown(notify);
-					--count;
+					NotifyWindow *merge = 0; // a burst from one peer updates its visible notify
+					for (NotifyWindows::const_iterator i = notifyWindows.cbegin(), e = notifyWindows.cend(); i != e; ++i) {
+						if ((*i)->canMergeWith(history, ms)) {
+							merge = *i;
+							break;
+						}
+					}
+					if (merge) { // take all due notifications of this history and render them once
+						NotifyWhenMaps::iterator j = notifyWhenMaps.find(history);
+						while (j != notifyWhenMaps.end() && history->hasNotification()) {
+							HistoryItem *pending = history->currentNotification();
+							NotifyWhenMap::iterator k = j.value().find(pending->id);
+							if (k == j.value().end()) {
+								history->skipNotification();
+								continue;
+							}
+							if (k.value() > ms) {
+								notifyWaiters.insert(history, NotifyWaiter(k.key(), k.value(), 0));
+								break;
+							}
+							j.value().erase(k);
+							history->skipNotification();
+							notifyItem = pending;
+							++fwdCount;
+						}
+						merge->mergeItems(notifyItem, fwdCount);
+						STATS_ADD("notify_merged", fwdCount);
+					} else {
+						NotifyWindow *notify = new NotifyWindow(notifyItem, x, y, fwdCount);
+						notifyWindows.push_back(notify);
+						psNotifyShown(notify);
+						STATS_ADD("notify_shown", 1);
+						--count;
+					}
 				} else {
 					psPlatformNotify(notifyItem, fwdCount);
 				}
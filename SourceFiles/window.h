@@ -79,6 +79,11 @@ public:
 	void updateNotifyDisplay();
 	void updatePeerPhoto();
 
+	bool canMergeWith(History *hist, uint64 ms) const {
+		return history && history == hist && !hiding && ms < _updatedAt + NotifyMergeTimeout;
+	}
+	void mergeItems(HistoryItem *last, int32 count);
+
 	void itemRemoved(HistoryItem *del);
 
 	int32 index() const {
@@ -103,7 +108,8 @@ private:
 #endif
 	History *history;
 	HistoryItem *item;
-	int32 fwdCount;
+	int32 fwdCount, _msgsCount; // _msgsCount > fwdCount when other messages were merged in
+	uint64 _updatedAt;
 	IconedButton close;
 	QPixmap pm;
 	float64 alphaDuration, posDuration;
@@ -353,6 +359,7 @@ private:
 	NotifyWhenAlerts notifyWhenAlerts;
 
 	NotifyWindows notifyWindows;
+	uint64 _lastNotifySoundAt;
 
 	MediaView *_mediaView;
 };